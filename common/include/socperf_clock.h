@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SOC_PERF_COMMON_INCLUDE_SOCPERF_CLOCK_H
+#define SOC_PERF_COMMON_INCLUDE_SOCPERF_CLOCK_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace OHOS {
+namespace SOCPERF {
+/*
+ * Time source of socperf. Boost end times and request debouncing run on the monotonic clock so that
+ * wall-clock adjustments can't stretch or cut a boost. Host simulations switch it to virtual time,
+ * which only moves when the executor advances it.
+ */
+class SocPerfClock {
+public:
+    static SocPerfClock& GetInstance()
+    {
+        static SocPerfClock instance;
+        return instance;
+    }
+
+    int64_t NowUs() const
+    {
+        if (virtualTime_.load(std::memory_order_relaxed)) {
+            return virtualNowUs_.load(std::memory_order_acquire);
+        }
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    int64_t NowMs() const
+    {
+        return NowUs() / US_PER_MS;
+    }
+
+    // the perf so takes end times as wall-clock milliseconds
+    int64_t ToWallTimeMs(int64_t monoMs) const
+    {
+        int64_t wallNowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        return monoMs - NowMs() + wallNowMs;
+    }
+
+    void EnableVirtualTime(int64_t beginUs)
+    {
+        virtualNowUs_.store(beginUs, std::memory_order_release);
+        virtualTime_.store(true, std::memory_order_relaxed);
+    }
+
+    void DisableVirtualTime()
+    {
+        virtualTime_.store(false, std::memory_order_relaxed);
+    }
+
+    bool IsVirtualTime() const
+    {
+        return virtualTime_.load(std::memory_order_relaxed);
+    }
+
+    // virtual time never goes backwards
+    void AdvanceTo(int64_t nowUs)
+    {
+        int64_t cur = virtualNowUs_.load(std::memory_order_acquire);
+        while (cur < nowUs && !virtualNowUs_.compare_exchange_weak(cur, nowUs, std::memory_order_acq_rel)) {
+        }
+    }
+
+private:
+    SocPerfClock() = default;
+    static constexpr int64_t US_PER_MS = 1000;
+    std::atomic<bool> virtualTime_ {false};
+    std::atomic<int64_t> virtualNowUs_ {0};
+};
+} // namespace SOCPERF
+} // namespace OHOS
+
+#endif // SOC_PERF_COMMON_INCLUDE_SOCPERF_CLOCK_H
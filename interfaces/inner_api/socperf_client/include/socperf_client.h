@@ -136,6 +136,8 @@ private:
 private:
     std::mutex mutex_;
     sptr<SocPerfDeathRecipient> recipient_;
+    // lets the server release the holds of this process when it dies
+    sptr<IRemoteObject> clientToken_;
 };
 } // namespace SOCPERF
 } // namespace OHOS
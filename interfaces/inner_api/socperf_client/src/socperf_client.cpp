@@ -15,6 +15,7 @@
 
 #include "socperf_client.h"
 #include <unistd.h>              // for getpid, gettid
+#include "ipc_object_stub.h"
 #include "iservice_registry.h"
 #include "isoc_perf.h"  // for ISocPerf
 #include "socperf_log.h"
@@ -73,6 +74,12 @@ bool SocPerfClient::CheckClientValid()
         return false;
     }
     client->AsObject()->AddDeathRecipient(recipient_);
+    if (!clientToken_) {
+        clientToken_ = new (std::nothrow) IPCObjectStub(u"ohos.socperf.client");
+    }
+    if (clientToken_) {
+        client->RegisterClient(clientToken_);
+    }
     SOC_PERF_LOGI("SocPerfClient:new client");
     return true;
 }
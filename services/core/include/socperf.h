@@ -21,6 +21,7 @@
 #include "libxml/tree.h"
 #include "socperf_thread_wrap.h"
 #include "socperf_config.h"
+#include "socperf_recorder.h"
 
 namespace OHOS {
 namespace SOCPERF {
@@ -28,27 +29,39 @@ class SocPerf {
 public:
     bool Init();
     void PerfRequest(int32_t cmdId, const std::string& msg);
-    void PerfRequestEx(int32_t cmdId, bool onOffTag, const std::string& msg);
+    // returns the cmdId the request was matched to under the current device modes, or INVALID_CMD_ID when it
+    // did not reach the queue; callerPid is reported when a hold is dropped by the maxHold watchdog
+    int32_t PerfRequestEx(int32_t cmdId, bool onOffTag, const std::string& msg, int32_t callerPid = 0);
+    // drops the hold a dead client left on the cmdId PerfRequestEx matched, not throttled like PerfRequestEx
+    void ReleasePerfRequestEx(int32_t matchCmdId, const std::string& msg);
     void PowerLimitBoost(bool onOffTag, const std::string& msg);
     void ThermalLimitBoost(bool onOffTag, const std::string& msg);
-    void LimitRequest(int32_t clientId,
+    bool LimitRequest(int32_t clientId,
         const std::vector<int32_t>& tags, const std::vector<int64_t>& configs, const std::string& msg);
     void SetRequestStatus(bool status, const std::string& msg);
     void SetThermalLevel(int32_t level);
     void RequestDeviceMode(const std::string& mode, bool status);
     std::string RequestCmdIdCount(const std::string& msg);
+    void StartRecord();
+    void StopRecord();
+    std::string GetRecordHex();
+    std::string GetLatencyInfo();
+    std::string GetStateInfo();
+    std::string GetQueueInfo();
 public:
     SocPerf();
     ~SocPerf();
 
 private:
     bool enabled_ = false;
+    // the primary worker, also first in socperfThreadWraps_
     std::shared_ptr<SocPerfThreadWrap> socperfThreadWrap_;
-    std::set<std::string> recordDeviceMode_;
-    std::vector<std::unordered_map<int32_t, int32_t>> limitRequest_ =
-        std::vector<std::unordered_map<int32_t, int32_t>>(ACTION_TYPE_MAX);
+    std::vector<std::shared_ptr<SocPerfThreadWrap>> socperfThreadWraps_;
+    // bits of SocPerfConfig::deviceModes_ that are active
+    std::atomic<uint64_t> deviceModeMask_ {0};
+    // cmd table of the active modes merged by priority, rebuilt under mutexActionsInfo_ when they change
+    std::shared_ptr<std::unordered_map<int32_t, std::shared_ptr<Actions>>> activeActionsInfo_;
     volatile bool perfRequestEnable_ = true;
-    int32_t thermalLvl_ = DEFAULT_THERMAL_LVL;
     bool batteryLimitStatus_ = false;
     bool powerLimitStatus_ = false;
     SocPerfConfig &socPerfConfig_ = SocPerfConfig::GetInstance();
@@ -57,23 +70,25 @@ private:
     std::unordered_map<int32_t, uint32_t> dailyCmdIdCount_;
     ffrt::task_handle statisticsTimer_;
     std::atomic<bool> statisticsTimerRunning_{false};
+    SocPerfRecorder recorder_;
 private:
-    std::mutex mutex_;
-    std::mutex mutexDeviceMode_;
+    std::mutex mutexActionsInfo_;
     std::mutex mutexBoostCmdCount_;
     std::mutex mutexBoostTime_;
     std::mutex mutexDailyCmdIdCount_;
     std::recursive_mutex mutexStatisticsTimer_;
     static const int64_t STATISTICS_REPORT_INTERVAL_US = 24 * 60 * 60 * 1000000LL;
     bool CreateThreadWraps();
+    void InitLatencyCmdIds();
     void InitThreadWraps();
-    void DoFreqActions(std::shared_ptr<Actions> actions, int32_t onOff, int32_t actionType);
+    void DoFreqActions(std::shared_ptr<Actions> actions, int32_t onOff, int32_t actionType, int32_t callerPid);
+    std::vector<std::shared_ptr<ResActionItem>> SplitPackByWorker(std::shared_ptr<ResActionItem> head);
+    void DispatchFreqActionPack(std::shared_ptr<ResActionItem> head);
+    void SetHoldWatchdog(std::shared_ptr<ResActionItem> head, int32_t maxHoldMs, int32_t callerPid);
+    std::shared_ptr<SocPerfThreadWrap> GetThreadWrap(int32_t resId);
     std::shared_ptr<ResActionItem> DoPerfRequestThremalLvl(int32_t cmdId, std::shared_ptr<Action> originAction,
         int32_t onOff, std::shared_ptr<ResActionItem> curItem, int64_t endTime);
-    void SendLimitRequestEvent(int32_t clientId, int32_t resId, int64_t resValue);
     int32_t MatchDeviceModeCmd(int32_t cmdId, bool isTagOnOff);
-    void SendLimitRequestEventOff(int32_t clientId, int32_t resId, int32_t eventId);
-    void SendLimitRequestEventOn(int32_t clientId, int32_t resId, int64_t resValue, int32_t eventId);
     void ClearAllAliveRequest();
     void UpdateCmdIdCount(int32_t cmdId);
     void UpdateDailyCmdIdCount(int32_t cmdId);
@@ -84,10 +99,9 @@ private:
         std::unordered_map<int32_t, std::shared_ptr<Actions>>& perfActionsInfo);
     bool CheckTimeInterval(bool onOff, int32_t cmdId);
     bool CompleteEvent();
-    std::string GetDeviceMode();
+    void UpdateActiveActionsInfo();
     int32_t GetMatchCmdId(int32_t cmdId, bool isTagOnOff);
-    std::string MatchDeviceMode(const std::string& mode, bool status,
-        const std::vector<std::shared_ptr<SceneItem>>& items);
+    std::string MatchDeviceMode(const std::string& mode, bool status, std::shared_ptr<SceneResNode> sceneResNode);
     std::shared_ptr<Actions> GetActionsInfo(int32_t cmdId);
 };
 } // namespace SOCPERF
@@ -16,6 +16,7 @@
 #ifndef SOC_PERF_SERVICES_CORE_INCLUDE_SOCPERF_COMMON_H
 #define SOC_PERF_SERVICES_CORE_INCLUDE_SOCPERF_COMMON_H
 
+#include <algorithm>
 #include <climits>
 #include <list>
 #include <string>
@@ -59,39 +60,112 @@ inline const int32_t RES_ID_NUMS_PER_TYPE_EXT            = 10000;
 inline const int32_t WRITE_NODE                          = 0;
 inline const int32_t REPORT_TO_PERFSO                    = 1;
 inline const int32_t PERF_OPEN_TRACE                     = 1;
+inline const int32_t PERF_OPEN_READ_BACK                 = 1;
 inline const int32_t INVALID_THERMAL_CMD_ID              = -1;
+inline const int32_t INVALID_CMD_ID                      = -1;
 inline const int32_t INVALID_DURATION                    = -1;
 inline const int32_t INVALID_THERMAL_LVL                 = -1;
 inline const int32_t DEFAULT_THERMAL_LVL                 = 0;
+inline const int32_t MAX_THERMAL_LVL                     = 100;
 inline const int32_t RES_MODE_AND_ID_PAIR                = 2;
 inline const int32_t MAX_RES_MODE_LEN                    = 64;
+inline const int32_t MAX_DEVICE_MODE_CNT                 = 64;
 inline const int32_t MAX_FREQUE_NODE                     = 1;
 inline const int32_t NODE_DEFAULT_VALUE                  = -1;
 inline const int32_t TYPE_TRACE_DEBUG                    = 3;
 inline const std::string DEFAULT_CONFIG_MODE             = "default";
+inline const std::string CONSTRAINT_TYPE_ORDER_STR       = "order";
+inline const std::string CONSTRAINT_TYPE_FOLLOW_STR      = "follow";
+inline const int32_t MIN_CONSTRAINT_GROUP_SIZE           = 2;
+inline const int32_t MAX_WORKER_CNT                      = 8;
+inline const std::string SNAP_MODE_FLOOR_STR             = "floor";
+inline const std::string SNAP_MODE_CEIL_STR              = "ceil";
+inline const std::string SNAP_MODE_NEAREST_STR           = "nearest";
 inline const uint32_t ABNORMAL_TYPE_PARSE_SOCPERF_BOOST_CONFIG_EXT = 5;
+inline const uint32_t ABNORMAL_TYPE_SOCPERF_HOLD_EXPIRED = 6;
+
+enum SnapMode {
+    SNAP_MODE_NONE = 0,
+    SNAP_MODE_FLOOR,
+    SNAP_MODE_CEIL,
+    SNAP_MODE_NEAREST
+};
 
 class ResourceNode {
 public:
     int32_t id;
     std::string name;
     int64_t def;
-    std::unordered_set<int64_t> available;
+    // sorted ascending without duplicates, built once at config load
+    std::vector<int64_t> available;
     int32_t persistMode;
     bool isGov;
     bool isMaxValue;
     bool trace = false;
+    int32_t snapMode = SNAP_MODE_NONE;
 public:
     ResourceNode(int32_t id, const std::string& name, int32_t persistMode, bool isGov, bool isMaxValue) : id(id),
         name(name), def(INVALID_VALUE), persistMode(persistMode), isGov(isGov), isMaxValue(isMaxValue) {}
     virtual ~ResourceNode() {};
     virtual void PrintString() {};
+
+    void AddAvailable(int64_t value)
+    {
+        auto iter = std::lower_bound(available.begin(), available.end(), value);
+        if (iter == available.end() || *iter != value) {
+            available.insert(iter, value);
+        }
+    }
+
+    bool IsAvailable(int64_t value) const
+    {
+        return std::binary_search(available.begin(), available.end(), value);
+    }
+
+    // level 0 is the highest value, levels beyond the table fall to the lowest one
+    int64_t GetValueByLevel(int32_t level) const
+    {
+        int32_t len = (int32_t)available.size();
+        return available[level < len ? len - 1 - level : 0];
+    }
+
+    int64_t GetNearestAvailable(int64_t value) const
+    {
+        auto iter = std::lower_bound(available.begin(), available.end(), value);
+        if (iter == available.end()) {
+            return available.back();
+        }
+        if (iter == available.begin() || *iter - value <= value - *(iter - 1)) {
+            return *iter;
+        }
+        return *(iter - 1);
+    }
+
+    // moves an off-table value onto the table by snapMode, values beyond the table clamp to its ends
+    int64_t SnapAvailable(int64_t value) const
+    {
+        if (snapMode == SNAP_MODE_NONE || available.empty()) {
+            return value;
+        }
+        if (snapMode == SNAP_MODE_NEAREST) {
+            return GetNearestAvailable(value);
+        }
+        auto iter = std::lower_bound(available.begin(), available.end(), value);
+        if (iter != available.end() && *iter == value) {
+            return value;
+        }
+        if (snapMode == SNAP_MODE_CEIL) {
+            return iter == available.end() ? available.back() : *iter;
+        }
+        return iter == available.begin() ? available.front() : *(iter - 1);
+    }
 };
 
 class ResNode : public ResourceNode {
 public:
     std::string path;
     int32_t pair;
+    bool readBack = false;
 
 public:
     ResNode(int32_t resId, const std::string& resName, int32_t resMode, int32_t resPair, int32_t resPersistMode)
@@ -113,10 +187,47 @@ public:
     ~GovResNode() {}
 };
 
+enum ConstraintType {
+    CONSTRAINT_TYPE_ORDER = 0,
+    CONSTRAINT_TYPE_FOLLOW
+};
+
+class ConstraintGroup {
+public:
+    std::string name;
+    int32_t type;
+    // order: values are non-decreasing along resIds; follow: resIds[0] is the source, the others are targets
+    std::vector<int32_t> resIds;
+    // follow only, source value threshold to target floor, ascending by threshold
+    std::vector<std::pair<int64_t, int64_t>> floorMap;
+
+public:
+    ConstraintGroup(const std::string& name, int32_t type) : name(name), type(type) {}
+    ~ConstraintGroup() {}
+};
+
+class ConstraintDomain {
+public:
+    // resources linked by constraint groups, sorted from the bottom to the top of the order constraints
+    std::vector<int32_t> resIds;
+    std::vector<std::shared_ptr<ConstraintGroup>> followGroups;
+    // (lower resId, upper resId), ascending by the rank of the lower one
+    std::vector<std::pair<int32_t, int32_t>> raiseEdges;
+    // (lower resId, upper resId), descending by the rank of the upper one
+    std::vector<std::pair<int32_t, int32_t>> limitEdges;
+    bool hasMaxRes = false;
+
+public:
+    ConstraintDomain() {}
+    ~ConstraintDomain() {}
+};
+
 class SceneItem {
 public:
     std::string name;
     int32_t req;
+    // bit of name in the active device mode mask, 0 when it was not interned
+    uint64_t modeBit = 0;
 
 public:
     SceneItem(const std::string& name, int32_t req) : name(name), req(req) {}
@@ -128,6 +239,8 @@ public:
     std::string name;
     int32_t persistMode;
     std::vector<std::shared_ptr<SceneItem>> items;
+    // modes of one type exclude each other, switching to one clears the rest of this mask
+    uint64_t modeMask = 0;
 
 public:
     SceneResNode(const std::string& name, int32_t persistMode) : name(name), persistMode(persistMode) {}
@@ -138,6 +251,7 @@ class ModeMap {
 public:
     std::string mode;
     int32_t cmdId;
+    uint64_t modeBit = 0;
 
 public:
     ModeMap(const std::string& mode, int32_t cmdId) : mode(mode), cmdId(cmdId) {}
@@ -162,8 +276,18 @@ public:
     std::string name;
     std::list<std::shared_ptr<Action>> actionList;
     std::vector<std::shared_ptr<ModeMap>> modeMap;
+    // union of the modeBit of modeMap, no active mode in it means no match
+    uint64_t modeMask = 0;
     bool isLongTimePerf = false;
     bool interaction = true;
+    // longest a PerfRequestEx hold of this cmd is kept without its off, 0 is unlimited
+    int32_t maxHoldMs = 0;
+    // valid resources any thermal level of this cmd sets, ascending, built at config load
+    std::vector<int32_t> thermalResIds;
+    // lowest thermalLvl of actionList, row 0 of thermalLvlValues
+    int32_t thermalLvlBase = INVALID_THERMAL_LVL;
+    // per thermal level from thermalLvlBase up, the values of the selected action aligned with thermalResIds
+    std::vector<std::vector<int64_t>> thermalLvlValues;
 
 public:
     Actions(int32_t cmdId, const std::string& cmdName)
@@ -172,6 +296,16 @@ public:
         name = cmdName;
     }
     ~Actions() {}
+
+    int64_t GetThermalLvlValue(int32_t thermalLvl, int32_t resIndex) const
+    {
+        if (thermalLvlValues.empty() || thermalLvl < thermalLvlBase) {
+            return INVALID_VALUE;
+        }
+        // levels above the highest configured one keep its action
+        size_t row = std::min(static_cast<size_t>(thermalLvl - thermalLvlBase), thermalLvlValues.size() - 1);
+        return thermalLvlValues[row][resIndex];
+    }
 };
 
 class ResAction {
@@ -183,6 +317,15 @@ public:
     int32_t cmdId;
     int64_t endTime;
     bool interaction = true;
+    // ACTION_TYPE_PERFLVL only, value is looked up here at the thermal level of the queue
+    std::shared_ptr<Actions> thermalActions = nullptr;
+    // index of the resource in thermalActions->thermalResIds
+    int32_t thermalResIndex = 0;
+    // EVENT_ON holds of a cmd with maxHold only, the watchdog drops the hold after maxHoldMs
+    int32_t maxHoldMs = 0;
+    int32_t callerPid = 0;
+    // set on the first hold of a request, the worker that applied it reports the expiry once
+    bool reportExpiry = false;
 
 public:
     ResAction(int64_t resActionValue, int32_t resActionDuration, int32_t resActionType,
@@ -245,6 +388,7 @@ public:
     std::vector<int64_t> candidatesEndTime;
     int64_t candidate;
     int64_t currentValue;
+    // last value/endTime acknowledged by the backend, a failed report keeps the resource dirty
     int64_t previousValue;
     int64_t currentEndTime;
     int64_t previousEndTime;
@@ -272,6 +416,16 @@ public:
     ~ResStatus() {}
 };
 
+class RateLimitClass {
+public:
+    std::string name;
+    // tokens added per second and the bucket size, a request takes one token
+    int32_t rate = 0;
+    int32_t burst = 0;
+    // cmdIds of the class, empty for the class of every cmdId not listed elsewhere
+    std::vector<int32_t> cmdIds;
+};
+
 class InterAction {
 public:
     int32_t cmdId;
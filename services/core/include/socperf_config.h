@@ -31,6 +31,11 @@ public:
     bool Init();
     bool IsGovResId(int32_t resId) const;
     bool IsValidResId(int32_t resId) const;
+    bool BuildConstraintDomains();
+    int32_t GetWorkerId(int32_t resId) const;
+    int32_t GetResSlot(int32_t resId) const;
+    uint64_t GetDeviceModeBit(const std::string& mode) const;
+    std::shared_ptr<std::unordered_map<int32_t, std::shared_ptr<Actions>>> BuildActionsTable(uint64_t modeMask) const;
     static SocPerfConfig& GetInstance();
 
 public:
@@ -40,7 +45,28 @@ public:
     std::unordered_map<std::string, std::shared_ptr<SceneResNode>> sceneResourceInfo_;
     std::unordered_map<std::string, std::unordered_map<int32_t, std::shared_ptr<Actions>>> configPerfActionsInfo_;
     std::vector<std::shared_ptr<InterAction>> interAction_;
+    std::vector<std::shared_ptr<ConstraintGroup>> constraintGroups_;
+    std::vector<std::shared_ptr<ConstraintDomain>> constraintDomains_;
+    std::unordered_map<int32_t, int32_t> resConstraintDomain_;
+    // arbitration workers, each owning its own queue and a disjoint set of constraint domains
+    int32_t workerCnt_ = 1;
+    std::unordered_map<int32_t, int32_t> resWorker_;
+    // dense index of every resource, indexed by resId - MIN_RESOURCE_ID
+    std::vector<int32_t> resSlot_;
+    int32_t resSlotCnt_ = 0;
     int32_t minThermalLvl_ = INVALID_THERMAL_LVL;
+    // scene item names interned in ascending order, the id is the bit in the active device mode mask
+    std::vector<std::string> deviceModes_;
+    std::unordered_map<std::string, int32_t> deviceModeIds_;
+    // priority attribute of each Config mode, a higher one overlays a lower one when both are active
+    std::unordered_map<std::string, int32_t> configModePriority_;
+    // interned Config modes from the lowest to the highest priority, the smaller name last on a tie
+    std::vector<std::string> configModeOrder_;
+    // per caller request rate of each cmdId class, enforced by SocPerfServer
+    std::vector<std::shared_ptr<RateLimitClass>> rateLimitClasses_;
+    // boost time a caller may hold within the sliding window, 0 is unlimited
+    int32_t boostBudgetWindowMs_ = 0;
+    int32_t boostBudgetMs_ = 0;
 
 private:
     SocPerfConfig();
@@ -62,8 +88,22 @@ private:
     bool TraversalGovResource(int32_t persistMode, xmlNode* greatGrandson, const std::string& configFile,
         std::shared_ptr<GovResNode> govResNode);
     void LoadInfo(xmlNode* child, const std::string& configFile);
+    bool LoadConstraint(xmlNode* child, const std::string& configFile);
+    bool TraversalConstraintGroup(xmlNode* grandson, const std::string& configFile);
+    bool CheckConstraintGroupTag(const char* name, const char* type, const char* res,
+        const std::string& configFile) const;
+    bool LoadConstraintFloorMap(xmlNode* greatGrandson, const std::string& configFile,
+        std::shared_ptr<ConstraintGroup> group);
+    std::vector<std::shared_ptr<ConstraintGroup>> GetPairConstraintGroups() const;
+    bool CheckConstraintGroupValid(std::shared_ptr<ConstraintGroup> group) const;
+    bool SortConstraintDomain(std::shared_ptr<ConstraintDomain> domain,
+        const std::vector<std::pair<int32_t, int32_t>>& edges);
+    void BuildWorkerDomains();
+    void BuildResSlots();
+    void BuildDeviceModes();
     bool LoadConfig(const xmlNode* rootNode, const std::string& configFile);
     bool TraversalBoostResource(xmlNode* grandson, const std::string& configFile, std::shared_ptr<Actions> actions);
+    void BuildThermalLvlTable(std::shared_ptr<Actions> actions) const;
     bool ParseDuration(xmlNode* greatGrandson, const std::string& configFile, std::shared_ptr<Action> action) const;
     bool ParseResValue(xmlNode* greatGrandson, const std::string& configFile, std::shared_ptr<Action> action);
     bool CheckResourceTag(const char* id, const char* name, const char* pair, const char* mode,
@@ -81,11 +121,14 @@ private:
     bool CheckActionResIdAndValueValid(const std::string& configFile);
     bool TraversalActions(std::shared_ptr<Action> action, int32_t actionId);
     bool CheckTrace(const char* trace);
+    bool CheckReadBack(const char* readBack);
+    bool ParseSnapMode(const char* snap, int32_t& snapMode) const;
     bool LoadSceneResource(xmlNode* rootNode, const std::string& configFile);
     bool TraversalSceneResource(xmlNode* greatGrandson, const std::string& configFile,
         std::shared_ptr<SceneResNode> sceneResNode);
     bool CheckSceneResourceTag(const char* name, const char* persistMode, const std::string& configFile) const;
     void LoadInterAction(xmlNode* child, const std::string& configFile);
+    void LoadRateLimit(xmlNode* child, const std::string& configFile);
     bool LoadCmdInfo(const xmlNode* rootNode, const std::string& configFile, const std::string& configMode);
     bool IsConfigTag(const xmlNode* rootNode);
     bool LoadConfigInfo(const xmlNode* configNode, const std::string& configFile, const std::string& configMode);
@@ -18,9 +18,19 @@
 
 #include "ffrt.h"
 #include "ffrt_inner.h"
+#include <atomic>
 #include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include "socperf_common.h"
 #include "socperf_config.h"
+#include "socperf_latency.h"
+#include "socperf_queue_stats.h"
 namespace OHOS { namespace SOCPERF { class GovResNode; } }
 namespace OHOS { namespace SOCPERF { class ResAction; } }
 namespace OHOS { namespace SOCPERF { class ResNode; } }
@@ -49,53 +59,169 @@ namespace {
     inline const std::string VALUE_STRING = "value";
 }
 
+struct SocPerfStateSnapshot {
+    // time the snapshot task waited behind earlier requests
+    int64_t queueWaitUs = 0;
+    int64_t takenMs = 0;
+    bool powerLimitBoost = false;
+    bool thermalLimitBoost = false;
+    bool weakInteractionStatus = false;
+    bool performanceModeStatus = false;
+    int32_t thermalLvl = DEFAULT_THERMAL_LVL;
+    std::vector<std::pair<int32_t, int32_t>> interActionStatus;
+    // cmdId to the number of resources it holds with PerfRequestEx
+    std::map<int32_t, int32_t> perfHolds;
+    // clientId to the limits it set by LimitRequest, level limits under resId + RES_ID_ADDITION
+    std::map<int32_t, std::map<int32_t, int64_t>> limitRequests;
+    // cmdId to the number of its holds dropped by the watchdog
+    std::map<int32_t, int32_t> holdLeaks;
+    std::map<int32_t, ResStatus> resStatus;
+};
+
+// live EVENT_ON actions of one (cmdId, action type), by resId in request order
+using ResActionHolds = std::unordered_map<int32_t, std::vector<std::list<std::shared_ptr<ResAction>>::iterator>>;
+
 class SocPerfThreadWrap {
 public:
-    explicit SocPerfThreadWrap();
+    explicit SocPerfThreadWrap(int32_t workerId = 0);
     ~SocPerfThreadWrap();
     void InitResourceNodeInfo();
+    // worker 0 is the primary, it also runs weak interaction and the statistics timer for all workers
+    void SetPrimaryWrap(std::shared_ptr<SocPerfThreadWrap> primaryWrap);
+    void SetPackDispatcher(std::function<void(std::shared_ptr<ResActionItem>)> packDispatcher);
+    void UpdateWorkerBoostStatus(bool boosting);
     void DoFreqActionPack(std::shared_ptr<ResActionItem> head);
     void UpdatePowerLimitBoostFreq(bool powerLimitBoost);
     void UpdateThermalLimitBoostFreq(bool thermalLimitBoost);
+    // re-evaluates the live PERFLVL actions at the new level in the same task
+    void SetThermalLevel(int32_t level);
     void UpdateLimitStatus(int32_t eventId, std::shared_ptr<ResAction> resAction, int32_t resId);
+    // applies a whole LimitRequest in one task, level limits carry resId + RES_ID_ADDITION
+    void UpdateLimitStatusPack(std::shared_ptr<ResActionItem> head);
+    void UpdateLimitRequest(int32_t clientId, const std::vector<int32_t>& tags, const std::vector<int64_t>& configs);
     void PostDelayTask(std::shared_ptr<ResActionItem> queueHead);
+    void PostHoldWatchdog(std::shared_ptr<ResActionItem> queueHead);
     void SetWeakInteractionStatus(bool enable);
     void ClearAllAliveRequest();
     void SubmitStatisticsTask(std::function<void()> func, ffrt::task_attr& taskAttr, ffrt::task_handle& timer);
     void CancelStatisticsTask(ffrt::task_handle& timer);
     void SetPerformanceModeStatus(bool enable);
-public:
-    int32_t thermalLvl_ = DEFAULT_THERMAL_LVL;
+    // hands the scenario to perf so off the caller thread, only the latest mode per type is sent
+    void PostScenario(const std::string& modeType, const std::string& modeStr);
+    // taken after everything queued before it
+    void GetStateSnapshot(SocPerfStateSnapshot& snapshot);
+    // the snapshot is filled on the queue, it must outlive the wait on the returned handle
+    ffrt::task_handle PostStateSnapshot(SocPerfStateSnapshot& snapshot, bool ahead);
+    void WaitStateSnapshot(const ffrt::task_handle& handle);
+    std::string GetQueueStatsInfo();
 
 private:
     static const int32_t SCALES_OF_MILLISECONDS_TO_MICROSECONDS = 1000;
+    static const int32_t READ_BACK_INTERVAL_MS = 1000;
+    static const int32_t REPORT_RETRY_DELAY_MS = 50;
+    static const int32_t MAX_REPORT_RETRY_TIMES = 3;
+    static const int32_t REPORT_RETRY_SLOW_DELAY_MS = 1000;
+    static const int32_t MAX_NODE_VALUE_LEN = 32;
+    int32_t workerId_ = 0;
+    std::string queueName_;
     std::unordered_map<int32_t, std::shared_ptr<ResStatus>> resStatusInfo_;
     SocPerfConfig &socPerfConfig_ = SocPerfConfig::GetInstance();
     ffrt::queue socperfQueue_;
     bool powerLimitBoost_ = false;
     bool thermalLimitBoost_ = false;
+    int32_t thermalLvl_ = DEFAULT_THERMAL_LVL;
     bool weakInteractionStatus_ = true;
     bool performanceModeStatus_ = false;
     int boostResCnt = 0;
+    // primary only, workers with live interaction boosts
+    int32_t workerBoostCnt_ = 0;
+    // non-primary only, the boost status last reported to the primary
+    bool reportedBoosting_ = false;
+    std::weak_ptr<SocPerfThreadWrap> primaryWrap_;
+    std::function<void(std::shared_ptr<ResActionItem>)> packDispatcher_;
+    // nodes socperf writes and reads back to reconcile, the read back timer is pending, queue only
+    std::vector<int32_t> readBackResIds_;
+    bool readBackTimerPending_ = false;
+    bool reportRetryPending_ = false;
+    int32_t reportRetryCnt_ = 0;
+    std::unordered_set<int32_t> dirtyConstraintDomains_;
+    LatencyTrace* activeTrace_ = nullptr;
+    SocPerfQueueStats queueStats_;
+    // latest timed request pack submitted per cmdId, guarded by packSeqMutex_
+    std::mutex packSeqMutex_;
+    std::unordered_map<int32_t, uint64_t> latestPackSeq_;
+    // bumped when all perf requests are cleared, packs submitted before it drop their perf actions
+    std::atomic<uint64_t> perfClearSeq_ {0};
+    // EVENT_ON entries of resActionList by (cmdId, type), an OFF finds its entry without scanning the list
+    std::map<std::pair<int32_t, int32_t>, ResActionHolds> holdIndex_;
+    // pending maxHold watchdog by cmdId, canceled once the last hold of the cmd goes, queue only
+    std::unordered_map<int32_t, ffrt::task_handle> holdWatchdogs_;
+    // holds dropped by the watchdog per cmdId, queue only
+    std::map<int32_t, int32_t> holdLeaks_;
+    // LimitRequest values per clientId over resource slots, level limits after resSlotCnt_ slots, queue only
+    std::vector<std::vector<int64_t>> limitRequest_;
+    // latest scenario mode per mode type not yet sent to perf so, guarded by scenarioMutex_
+    std::mutex scenarioMutex_;
+    std::unordered_map<std::string, std::string> pendingScenario_;
 
 private:
+    void SubmitRequestTask(uint8_t type, const std::function<void()>& func);
+    std::function<void()> WrapQueueTask(uint8_t type, const std::function<void()>& func,
+        const ffrt::task_attr& taskAttr);
+    void SubmitQueueTask(uint8_t type, const std::function<void()>& func, const ffrt::task_attr& taskAttr = {});
+    ffrt::task_handle SubmitQueueTaskH(uint8_t type, const std::function<void()>& func,
+        const ffrt::task_attr& taskAttr = {});
+    void CancelQueueTask(uint8_t type, ffrt::task_handle& handle);
+    void ApplyLimitStatusPack(std::shared_ptr<ResActionItem> head);
+    // one table per client, sized for the resource slots of the config
+    void InitLimitRequest();
+    int64_t* GetLimitRequestValue(int32_t clientId, int32_t resId);
+    std::shared_ptr<ResActionItem> ReleaseLimitRequest(int32_t clientId, int32_t resId,
+        std::shared_ptr<ResActionItem> curItem);
+    std::shared_ptr<ResActionItem> BuildLimitRequestPack(int32_t clientId, const std::vector<int32_t>& tags,
+        const std::vector<int64_t>& configs);
+    bool IsPackSupersedable(std::shared_ptr<ResActionItem> head);
+    uint64_t MarkLatestPack(int32_t cmdId);
+    bool IsPackSuperseded(int32_t cmdId, uint64_t packSeq);
+    bool IsResActionExpired(std::shared_ptr<ResAction> resAction, int64_t nowMs);
     void InitResStatus();
     void SendResStatus();
-    void ReportToPerfSo(std::vector<int32_t>& qosId, std::vector<int64_t>& value, std::vector<int64_t>& endTime);
+    bool ReportToPerfSo(std::vector<int32_t>& qosId, std::vector<int64_t>& value, std::vector<int64_t>& endTime);
     void ReportToRssExe(std::vector<int32_t>& qosId, std::vector<int64_t>& value, std::vector<int64_t>& endTime);
+    bool IsResStatusChanged(int32_t resId);
+    std::vector<int32_t> GetOrderedChangedResIds();
+    bool IsResValueRaised(int32_t resId);
+    void AckResStatus(const std::vector<int32_t>& qosId, const std::vector<int64_t>& value,
+        const std::vector<int64_t>& endTime);
+    void PostReportRetryTask();
+    void StartReadBackTimer();
+    bool HasReadBackHold();
+    void DoReconcileResStatus();
+    bool IsNodeValueApplied(std::shared_ptr<ResNode> resNode, int64_t appliedValue, int64_t nodeValue);
+    bool ReadResNodeValue(const std::string& path, int64_t& value);
     bool GetResValueByLevel(int32_t resId, int32_t level, int64_t& resValue);
     void UpdateResActionList(int32_t resId, std::shared_ptr<ResAction> resAction, bool delayed);
     void UpdateResActionListByDelayedMsg(int32_t resId, int32_t type,
         std::shared_ptr<ResAction> resAction, std::shared_ptr<ResStatus> resStatus);
     void UpdateResActionListByInstantMsg(int32_t resId, int32_t type,
         std::shared_ptr<ResAction> resAction, std::shared_ptr<ResStatus> resStatus);
+    void AddHold(int32_t resId, std::list<std::shared_ptr<ResAction>>::iterator actionIter);
+    void RemoveHold(int32_t resId, std::list<std::shared_ptr<ResAction>>::iterator actionIter);
+    bool ReleaseHold(int32_t resId, std::shared_ptr<ResAction> resAction, std::shared_ptr<ResStatus> resStatus);
+    void ExpireHolds(const std::vector<std::shared_ptr<ResActionItem>>& items);
+    bool HasCmdHold(int32_t cmdId) const;
+    void CancelHoldWatchdog(int32_t cmdId);
+    int64_t GetPerfLvlValue(std::shared_ptr<ResAction> resAction);
     void UpdateCandidatesValue(int32_t resId, int32_t type);
     void InnerArbitrateCandidatesValue(int32_t type, std::shared_ptr<ResStatus> resStatus);
     void ArbitrateCandidate(int32_t resId);
-    void ArbitratePairRes(int32_t resId, bool perfRequestLimit);
     void ProcessLimitCase(int32_t resId);
-    bool ArbitratePairResInPerfLvl(int32_t resId);
-    void UpdatePairResValue(int32_t minResId, int64_t minResValue, int32_t maxResId, int64_t maxResValue);
+    void ArbitratePerfLvl(std::shared_ptr<ResStatus> resStatus);
+    void ArbitrateConstraintDomains();
+    void ArbitrateConstraintDomain(int32_t domainId);
+    bool ExistPerfLvlInDomain(std::shared_ptr<ConstraintDomain> domain);
+    void ArbitrateFollowGroup(std::shared_ptr<ConstraintGroup> group);
+    int64_t GetLimitCeiling(std::shared_ptr<ResStatus> resStatus);
     void UpdateCurrentValue(int32_t resId, int64_t value);
     bool ExistNoCandidate(int32_t resId, std::shared_ptr<ResStatus> resStatus);
     void DoFreqAction(int32_t resId, std::shared_ptr<ResAction> resAction);
@@ -104,6 +230,9 @@ private:
         std::shared_ptr<ResAction> resAction, std::shared_ptr<ResStatus> resStatus);
     void DoWeakInteraction(std::shared_ptr<Actions> actions, int32_t onOff, int32_t actionType);
     void WeakInteraction();
+    bool IsBoosting() const;
+    void ReportBoostStatus();
+    bool IsOwnedResId(int32_t resId) const;
     int32_t GetModeCmdId(int32_t cmdId);
 };
 } // namespace SOCPERF
@@ -15,7 +15,10 @@
 
 #include "socperf.h"
 
+#include <algorithm>
+
 #include "parameters.h"
+#include "socperf_clock.h"
 #include "socperf_trace.h"
 #include "socperf_hitrace_chain.h"
 
@@ -32,13 +35,17 @@ namespace {
     const int32_t MODE_TYPE_INDEX = 0;
     const int32_t MODE_NAME_INDEX = 1;
     const int32_t CONFIG_MIN_SIZE = 1;
-    const int32_t INVALID_CMD_ID = -1;
-    const int32_t BATTERY_LIMIT_CMD_ID = -2;
     const int32_t PERF_REQUEST_CMD_ID_EVENT_FLING           = 10008;
     const int32_t PERF_REQUEST_CMD_ID_EVENT_TOUCH_DOWN      = 10010;
     const int32_t PERF_REQUEST_CMD_ID_EVENT_TOUCH_UP        = 10040;
     const int32_t PERF_REQUEST_CMD_ID_EVENT_DRAG            = 10092;
     const uint32_t STATISTICS_TYPE_SOCPERF_CMD             = 2;
+    const char* const ACTION_TYPE_NAMES[ACTION_TYPE_MAX] = { "perf", "power", "thermal", "perflvl", "battery" };
+
+    std::string FormatRemainTime(int64_t endTime, int64_t nowMs)
+    {
+        return endTime == MAX_INT_VALUE ? "hold" : std::to_string(endTime - nowMs) + "ms";
+    }
 
 }
 SocPerf::SocPerf()
@@ -48,6 +55,10 @@ SocPerf::SocPerf()
 SocPerf::~SocPerf()
 {
     StopStatisticsTimer();
+    // the other workers report to the primary, so they go first
+    while (!socperfThreadWraps_.empty()) {
+        socperfThreadWraps_.pop_back();
+    }
     socperfThreadWrap_ = nullptr;
 }
 
@@ -65,24 +76,104 @@ bool SocPerf::Init()
     InitThreadWraps();
     enabled_ = true;
     CompleteEvent();
+    UpdateActiveActionsInfo();
+    InitLatencyCmdIds();
     StartStatisticsTimer();
     return true;
 }
 
+void SocPerf::InitLatencyCmdIds()
+{
+    std::vector<int32_t> cmdIds;
+    for (const auto& config : socPerfConfig_.configPerfActionsInfo_) {
+        for (const auto& actions : config.second) {
+            cmdIds.push_back(actions.first);
+        }
+    }
+    SocPerfLatency::GetInstance().InitCmdIds(cmdIds);
+}
+
 bool SocPerf::CreateThreadWraps()
 {
-    socperfThreadWrap_ = std::make_shared<SocPerfThreadWrap>();
-    if (!socperfThreadWrap_) {
-        SOC_PERF_LOGE("Failed to Create socPerfThreadWrap");
-        return false;
+    for (int32_t workerId = 0; workerId < socPerfConfig_.workerCnt_; workerId++) {
+        auto threadWrap = std::make_shared<SocPerfThreadWrap>(workerId);
+        if (!threadWrap) {
+            SOC_PERF_LOGE("Failed to Create socPerfThreadWrap %{public}d", workerId);
+            return false;
+        }
+        socperfThreadWraps_.push_back(threadWrap);
     }
+    socperfThreadWrap_ = socperfThreadWraps_.front();
     SOC_PERF_LOGD("Success to Create All threadWrap threads");
     return true;
 }
 
 void SocPerf::InitThreadWraps()
 {
-    socperfThreadWrap_->InitResourceNodeInfo();
+    for (size_t i = 1; i < socperfThreadWraps_.size(); i++) {
+        socperfThreadWraps_[i]->SetPrimaryWrap(socperfThreadWrap_);
+    }
+    if (socperfThreadWraps_.size() > 1) {
+        // weak interaction runs on the primary but its actions may belong to any worker
+        socperfThreadWrap_->SetPackDispatcher([this](std::shared_ptr<ResActionItem> head) {
+            DispatchFreqActionPack(head);
+        });
+    }
+    for (const auto& threadWrap : socperfThreadWraps_) {
+        threadWrap->InitResourceNodeInfo();
+    }
+}
+
+std::shared_ptr<SocPerfThreadWrap> SocPerf::GetThreadWrap(int32_t resId)
+{
+    int32_t workerId = socPerfConfig_.GetWorkerId(resId);
+    if (workerId < 0 || workerId >= (int32_t)socperfThreadWraps_.size()) {
+        return socperfThreadWrap_;
+    }
+    return socperfThreadWraps_[workerId];
+}
+
+std::vector<std::shared_ptr<ResActionItem>> SocPerf::SplitPackByWorker(std::shared_ptr<ResActionItem> head)
+{
+    if (socperfThreadWraps_.size() <= 1) {
+        return { head };
+    }
+    // the ResActions are shared so the delayed release still finds what it applied
+    std::vector<std::shared_ptr<ResActionItem>> heads(socperfThreadWraps_.size());
+    std::vector<std::shared_ptr<ResActionItem>> tails(socperfThreadWraps_.size());
+    for (std::shared_ptr<ResActionItem> item = head; item; item = item->next) {
+        int32_t workerId = socPerfConfig_.GetWorkerId(item->resId);
+        if (workerId < 0 || workerId >= (int32_t)socperfThreadWraps_.size()) {
+            continue;
+        }
+        auto workerItem = std::make_shared<ResActionItem>(item->resId);
+        workerItem->resAction = item->resAction;
+        if (tails[workerId]) {
+            tails[workerId]->next = workerItem;
+        } else {
+            heads[workerId] = workerItem;
+        }
+        tails[workerId] = workerItem;
+    }
+    return heads;
+}
+
+void SocPerf::DispatchFreqActionPack(std::shared_ptr<ResActionItem> head)
+{
+    if (socperfThreadWraps_.size() <= 1) {
+        socperfThreadWrap_->DoFreqActionPack(head);
+        socperfThreadWrap_->PostDelayTask(head);
+        socperfThreadWrap_->PostHoldWatchdog(head);
+        return;
+    }
+    std::vector<std::shared_ptr<ResActionItem>> heads = SplitPackByWorker(head);
+    for (size_t i = 0; i < heads.size(); i++) {
+        if (heads[i] != nullptr) {
+            socperfThreadWraps_[i]->DoFreqActionPack(heads[i]);
+            socperfThreadWraps_[i]->PostDelayTask(heads[i]);
+            socperfThreadWraps_[i]->PostHoldWatchdog(heads[i]);
+        }
+    }
 }
 
 bool SocPerf::CompleteEvent()
@@ -108,8 +199,13 @@ void SocPerf::CopyEvent(const int32_t oldCmdId, const int32_t newCmdId,
     newActions->name = oldActions->name;
     newActions->actionList = oldActions->actionList;
     newActions->modeMap = oldActions->modeMap;
+    newActions->modeMask = oldActions->modeMask;
     newActions->isLongTimePerf = oldActions->isLongTimePerf;
+    newActions->thermalResIds = oldActions->thermalResIds;
+    newActions->thermalLvlBase = oldActions->thermalLvlBase;
+    newActions->thermalLvlValues = oldActions->thermalLvlValues;
     newActions->interaction = oldActions->interaction;
+    newActions->maxHoldMs = oldActions->maxHoldMs;
     perfActionsInfo[newCmdId] = newActions;
     socPerfConfig_.configPerfActionsInfo_[DEFAULT_CONFIG_MODE] = perfActionsInfo;
     SOC_PERF_LOGI("Complete event %{public}d", oldCmdId);
@@ -117,6 +213,8 @@ void SocPerf::CopyEvent(const int32_t oldCmdId, const int32_t newCmdId,
 
 void SocPerf::PerfRequest(int32_t cmdId, const std::string& msg)
 {
+    recorder_.Record(RECORD_ENTRY_PERF_REQUEST, cmdId, false);
+    SocPerfLatencyScope latencyScope(RECORD_ENTRY_PERF_REQUEST, cmdId);
     SocPerfHiTraceChain traceChain(__func__);
     if (!enabled_ || !perfRequestEnable_) {
         SOC_PERF_LOGD("SocPerf disabled!");
@@ -138,27 +236,29 @@ void SocPerf::PerfRequest(int32_t cmdId, const std::string& msg)
     trace_str.append(",cmdId[").append(std::to_string(matchCmdId)).append("]");
     trace_str.append(",msg[").append(msg).append("]");
     StartTraceEx(HITRACE_LEVEL_INFO, HITRACE_TAG_SOCPERF, trace_str.c_str());
-    DoFreqActions(GetActionsInfo(matchCmdId), EVENT_INVALID, ACTION_TYPE_PERF);
+    DoFreqActions(GetActionsInfo(matchCmdId), EVENT_INVALID, ACTION_TYPE_PERF, 0);
     FinishTraceEx(HITRACE_LEVEL_INFO, HITRACE_TAG_SOCPERF);
     UpdateCmdIdCount(cmdId);
     UpdateDailyCmdIdCount(cmdId);
 }
 
-void SocPerf::PerfRequestEx(int32_t cmdId, bool onOffTag, const std::string& msg)
+int32_t SocPerf::PerfRequestEx(int32_t cmdId, bool onOffTag, const std::string& msg, int32_t callerPid)
 {
+    recorder_.Record(RECORD_ENTRY_PERF_REQUEST_EX, cmdId, onOffTag);
+    SocPerfLatencyScope latencyScope(RECORD_ENTRY_PERF_REQUEST_EX, cmdId);
     SocPerfHiTraceChain traceChain(__func__);
     if (!enabled_ || !perfRequestEnable_) {
         SOC_PERF_LOGD("SocPerf disabled!");
-        return;
+        return INVALID_CMD_ID;
     }
     if (!CheckTimeInterval(onOffTag, cmdId)) {
         SOC_PERF_LOGD("cmdId %{public}d can not trigger, because time interval", cmdId);
-        return;
+        return INVALID_CMD_ID;
     }
     int32_t matchCmdId = GetMatchCmdId(cmdId, true);
     if (matchCmdId == INVALID_CMD_ID) {
         SOC_PERF_LOGD("Invalid PerfRequestEx cmdId[%{public}d]", cmdId);
-        return;
+        return INVALID_CMD_ID;
     }
     SOC_PERF_LOGD("cmdId[%{public}d]matchCmdId[%{public}d]onOffTag[%{public}d]msg[%{public}s]",
         cmdId, matchCmdId, onOffTag, msg.c_str());
@@ -168,16 +268,31 @@ void SocPerf::PerfRequestEx(int32_t cmdId, bool onOffTag, const std::string& msg
     trace_str.append(",onOff[").append(std::to_string(onOffTag)).append("]");
     trace_str.append(",msg[").append(msg).append("]");
     StartTraceEx(HITRACE_LEVEL_INFO, HITRACE_TAG_SOCPERF, trace_str.c_str());
-    DoFreqActions(GetActionsInfo(matchCmdId), onOffTag ? EVENT_ON : EVENT_OFF, ACTION_TYPE_PERF);
+    DoFreqActions(GetActionsInfo(matchCmdId), onOffTag ? EVENT_ON : EVENT_OFF, ACTION_TYPE_PERF, callerPid);
     FinishTraceEx(HITRACE_LEVEL_INFO, HITRACE_TAG_SOCPERF);
     if (onOffTag) {
         UpdateCmdIdCount(cmdId);
         UpdateDailyCmdIdCount(cmdId);
     }
+    return matchCmdId;
+}
+
+void SocPerf::ReleasePerfRequestEx(int32_t matchCmdId, const std::string& msg)
+{
+    // a matched cmdId matches itself, replaying this off drops the same hold whatever the modes are by then
+    recorder_.Record(RECORD_ENTRY_PERF_REQUEST_EX, matchCmdId, false);
+    if (!enabled_ || !perfRequestEnable_) {
+        // holds were cleared together with the request switch
+        return;
+    }
+    SOC_PERF_LOGI("release hold of matchCmdId[%{public}d]msg[%{public}s]", matchCmdId, msg.c_str());
+    DoFreqActions(GetActionsInfo(matchCmdId), EVENT_OFF, ACTION_TYPE_PERF, 0);
 }
 
 void SocPerf::PowerLimitBoost(bool onOffTag, const std::string& msg)
 {
+    recorder_.Record(RECORD_ENTRY_POWER_LIMIT_BOOST, 0, onOffTag, msg);
+    SocPerfLatencyScope latencyScope(RECORD_ENTRY_POWER_LIMIT_BOOST, INVALID_CMD_ID);
     SocPerfHiTraceChain traceChain(__func__);
     if (!enabled_) {
         SOC_PERF_LOGD("SocPerf disabled!");
@@ -195,7 +310,9 @@ void SocPerf::PowerLimitBoost(bool onOffTag, const std::string& msg)
     trace_str.append(",onOff[").append(std::to_string(onOffTag)).append("]");
     trace_str.append(",msg[").append(msg).append("]");
     StartTraceEx(HITRACE_LEVEL_INFO, HITRACE_TAG_SOCPERF, trace_str.c_str());
-    socperfThreadWrap_->UpdatePowerLimitBoostFreq(onOffTag);
+    for (const auto& threadWrap : socperfThreadWraps_) {
+        threadWrap->UpdatePowerLimitBoostFreq(onOffTag);
+    }
     HiSysEventWrite(OHOS::HiviewDFX::HiSysEvent::Domain::RSS, "LIMIT_BOOST",
                     OHOS::HiviewDFX::HiSysEvent::EventType::BEHAVIOR,
                     "CLIENT_ID", ACTION_TYPE_POWER,
@@ -205,6 +322,8 @@ void SocPerf::PowerLimitBoost(bool onOffTag, const std::string& msg)
 
 void SocPerf::ThermalLimitBoost(bool onOffTag, const std::string& msg)
 {
+    recorder_.Record(RECORD_ENTRY_THERMAL_LIMIT_BOOST, 0, onOffTag);
+    SocPerfLatencyScope latencyScope(RECORD_ENTRY_THERMAL_LIMIT_BOOST, INVALID_CMD_ID);
     SocPerfHiTraceChain traceChain(__func__);
     if (!enabled_) {
         SOC_PERF_LOGD("SocPerf disabled!");
@@ -215,7 +334,9 @@ void SocPerf::ThermalLimitBoost(bool onOffTag, const std::string& msg)
     trace_str.append(",onOff[").append(std::to_string(onOffTag)).append("]");
     trace_str.append(",msg[").append(msg).append("]");
     StartTraceEx(HITRACE_LEVEL_INFO, HITRACE_TAG_SOCPERF, trace_str.c_str());
-    socperfThreadWrap_->UpdateThermalLimitBoostFreq(onOffTag);
+    for (const auto& threadWrap : socperfThreadWraps_) {
+        threadWrap->UpdateThermalLimitBoostFreq(onOffTag);
+    }
     HiSysEventWrite(OHOS::HiviewDFX::HiSysEvent::Domain::RSS, "LIMIT_BOOST",
                     OHOS::HiviewDFX::HiSysEvent::EventType::BEHAVIOR,
                     "CLIENT_ID", ACTION_TYPE_THERMAL,
@@ -223,95 +344,55 @@ void SocPerf::ThermalLimitBoost(bool onOffTag, const std::string& msg)
     FinishTraceEx(HITRACE_LEVEL_INFO, HITRACE_TAG_SOCPERF);
 }
 
-void SocPerf::SendLimitRequestEventOff(int32_t clientId, int32_t resId, int32_t eventId)
-{
-    int32_t cmdId = -1;
-    int32_t newClientId = clientId;
-    if (newClientId == (int32_t)ACTION_TYPE_BATTERY) {
-        cmdId = BATTERY_LIMIT_CMD_ID;
-        newClientId = (int32_t)ACTION_TYPE_POWER;
-    }
-    auto iter = limitRequest_[clientId].find(resId);
-    if (iter != limitRequest_[clientId].end()
-        && limitRequest_[clientId][resId] != INVALID_VALUE) {
-        auto resAction = std::make_shared<ResAction>(
-            limitRequest_[clientId][resId], 0, newClientId, EVENT_OFF, cmdId, MAX_INT_VALUE);
-        socperfThreadWrap_->UpdateLimitStatus(eventId, resAction, resId);
-        limitRequest_[clientId].erase(iter);
-    }
-}
-
-void SocPerf::SendLimitRequestEventOn(int32_t clientId, int32_t resId, int64_t resValue, int32_t eventId)
-{
-    if (resValue != INVALID_VALUE && resValue != RESET_VALUE) {
-        int32_t cmdId = -1;
-        int32_t newClientId = clientId;
-        if (newClientId == (int32_t)ACTION_TYPE_BATTERY) {
-            cmdId = BATTERY_LIMIT_CMD_ID;
-            newClientId = (int32_t)ACTION_TYPE_POWER;
-        }
-        auto resAction = std::make_shared<ResAction>(resValue, 0, newClientId, EVENT_ON, cmdId, MAX_INT_VALUE);
-        socperfThreadWrap_->UpdateLimitStatus(eventId, resAction, resId);
-        limitRequest_[clientId].insert(std::pair<int32_t, int32_t>(resId, resValue));
-    }
-}
-
-void SocPerf::SendLimitRequestEvent(int32_t clientId, int32_t resId, int64_t resValue)
-{
-    int32_t eventId = 0;
-    int32_t realResId = 0;
-    int32_t levelResId = 0;
-    if (resId > RES_ID_ADDITION) {
-        realResId = resId - RES_ID_ADDITION;
-        levelResId = resId;
-        eventId = INNER_EVENT_ID_DO_FREQ_ACTION_LEVEL;
-        SOC_PERF_LOGI("SocPerf DO_FREQ_ACTION_LEVEL");
-    } else {
-        realResId = resId;
-        levelResId = resId + RES_ID_ADDITION;
-        eventId = INNER_EVENT_ID_DO_FREQ_ACTION;
-    }
-
-    if (!socPerfConfig_.IsValidResId(realResId)) {
-        return;
-    }
-    std::lock_guard<std::mutex> lock(mutex_);
-    SendLimitRequestEventOff(clientId, realResId, INNER_EVENT_ID_DO_FREQ_ACTION);
-    SendLimitRequestEventOff(clientId, levelResId, INNER_EVENT_ID_DO_FREQ_ACTION_LEVEL);
-    SendLimitRequestEventOn(clientId, resId, resValue, eventId);
-}
-
-void SocPerf::LimitRequest(int32_t clientId,
+bool SocPerf::LimitRequest(int32_t clientId,
     const std::vector<int32_t>& tags, const std::vector<int64_t>& configs, const std::string& msg)
 {
+    recorder_.Record(RECORD_ENTRY_LIMIT_REQUEST, clientId, false, "", tags, configs);
+    SocPerfLatencyScope latencyScope(RECORD_ENTRY_LIMIT_REQUEST, INVALID_CMD_ID);
     SocPerfHiTraceChain traceChain(__func__);
     if (!enabled_) {
         SOC_PERF_LOGE("SocPerf disabled!");
-        return;
+        return false;
     }
     if (tags.size() != configs.size()) {
         SOC_PERF_LOGE("tags'size and configs' size must be the same!");
-        return;
+        return false;
     }
     if (clientId <= (int32_t)ACTION_TYPE_PERF || clientId >= (int32_t)ACTION_TYPE_MAX) {
         SOC_PERF_LOGE("clientId must be between ACTION_TYPE_PERF and ACTION_TYPE_MAX!");
-        return;
+        return false;
     }
     std::string trace_str(__func__);
     trace_str.append(",clientId[").append(std::to_string(clientId)).append("]");
     trace_str.append(",msg[").append(msg).append("]");
+    // the limits are split by worker, each applies its share in one task with one flush
+    std::vector<std::vector<int32_t>> workerTags(socperfThreadWraps_.size());
+    std::vector<std::vector<int64_t>> workerConfigs(socperfThreadWraps_.size());
     for (int32_t i = 0; i < (int32_t)tags.size(); i++) {
         trace_str.append(",tags[").append(std::to_string(tags[i])).append("]");
         trace_str.append(",configs[").append(std::to_string(configs[i])).append("]");
-        SendLimitRequestEvent(clientId, tags[i], configs[i]);
+        size_t workerId = (size_t)socPerfConfig_.GetWorkerId(tags[i]);
+        if (workerId >= socperfThreadWraps_.size()) {
+            continue;
+        }
+        workerTags[workerId].push_back(tags[i]);
+        workerConfigs[workerId].push_back(configs[i]);
+    }
+    for (size_t i = 0; i < socperfThreadWraps_.size(); i++) {
+        if (!workerTags[i].empty()) {
+            socperfThreadWraps_[i]->UpdateLimitRequest(clientId, workerTags[i], workerConfigs[i]);
+        }
     }
     StartTraceEx(HITRACE_LEVEL_INFO, HITRACE_TAG_SOCPERF, trace_str.c_str());
     SOC_PERF_LOGI("socperf limit %{public}s", trace_str.c_str());
     FinishTraceEx(HITRACE_LEVEL_INFO, HITRACE_TAG_SOCPERF);
+    return true;
 }
 
 void SocPerf::SetRequestStatus(bool status, const std::string& msg)
 {
+    recorder_.Record(RECORD_ENTRY_SET_REQUEST_STATUS, 0, status);
+    SocPerfLatencyScope latencyScope(RECORD_ENTRY_SET_REQUEST_STATUS, INVALID_CMD_ID);
     SOC_PERF_LOGI("requestEnable is changed to %{public}d, the reason is %{public}s", status, msg.c_str());
     perfRequestEnable_ = status;
     /* disable socperf sever, we should clear all alive request to avoid high freq for long time */
@@ -326,11 +407,15 @@ void SocPerf::ClearAllAliveRequest()
         SOC_PERF_LOGE("SocPerf disabled!");
         return;
     }
-    socperfThreadWrap_->ClearAllAliveRequest();
+    for (const auto& threadWrap : socperfThreadWraps_) {
+        threadWrap->ClearAllAliveRequest();
+    }
 }
 
 void SocPerf::SetThermalLevel(int32_t level)
 {
+    recorder_.Record(RECORD_ENTRY_SET_THERMAL_LEVEL, level, false);
+    SocPerfLatencyScope latencyScope(RECORD_ENTRY_SET_THERMAL_LEVEL, INVALID_CMD_ID);
     SocPerfHiTraceChain traceChain(__func__);
     if (!enabled_) {
         SOC_PERF_LOGE("SocPerf disabled!");
@@ -341,8 +426,9 @@ void SocPerf::SetThermalLevel(int32_t level)
     StartTraceEx(HITRACE_LEVEL_INFO, HITRACE_TAG_SOCPERF, trace_str.c_str());
     SOC_PERF_LOGI("ThermalLevel:%{public}d", level);
     FinishTraceEx(HITRACE_LEVEL_INFO, HITRACE_TAG_SOCPERF);
-    thermalLvl_ = level;
-    socperfThreadWrap_->thermalLvl_ = level;
+    for (const auto& threadWrap : socperfThreadWraps_) {
+        threadWrap->SetThermalLevel(level);
+    }
 }
 
 std::shared_ptr<ResActionItem> SocPerf::DoPerfRequestThremalLvl(int32_t cmdId, std::shared_ptr<Action> originAction,
@@ -357,39 +443,28 @@ std::shared_ptr<ResActionItem> SocPerf::DoPerfRequestThremalLvl(int32_t cmdId, s
         return curItem;
     }
 
-    // select the Nearest thermallevel action
-    std::shared_ptr<Action> action = nullptr;
-    for (auto iter = cmdConfig->actionList.begin(); iter != cmdConfig->actionList.end(); iter++) {
-        if ((*iter)->thermalLvl_ <= thermalLvl_) {
-            if (action == nullptr || action->thermalLvl_ <= (*iter)->thermalLvl_) {
-                action = *iter;
-            }
-        }
-    }
-    if (action == nullptr) {
-        return curItem;
-    }
-
-    for (int32_t i = 0; i < (int32_t)action->variable.size() - 1; i += RES_ID_AND_VALUE_PAIR) {
-        if (!socPerfConfig_.IsValidResId(action->variable[i])) {
-            continue;
-        }
-
-        auto resActionItem = std::make_shared<ResActionItem>(action->variable[i]);
-        resActionItem->resAction = std::make_shared<ResAction>(action->variable[i + 1], originAction->duration,
+    // the value is looked up on the queue, at the thermal level current when the pack applies, holds below
+    // the min thermal level stay valueless; perf level actions never count as interaction boost either way
+    for (int32_t i = 0; i < (int32_t)cmdConfig->thermalResIds.size(); i++) {
+        auto resActionItem = std::make_shared<ResActionItem>(cmdConfig->thermalResIds[i]);
+        resActionItem->resAction = std::make_shared<ResAction>(INVALID_VALUE, originAction->duration,
             ACTION_TYPE_PERFLVL, onOff, cmdId, endTime);
+        resActionItem->resAction->thermalActions = cmdConfig;
+        resActionItem->resAction->thermalResIndex = i;
         curItem->next = resActionItem;
         curItem = curItem->next;
     }
     return curItem;
 }
 
-void SocPerf::DoFreqActions(std::shared_ptr<Actions> actions, int32_t onOff, int32_t actionType)
+void SocPerf::DoFreqActions(std::shared_ptr<Actions> actions, int32_t onOff, int32_t actionType, int32_t callerPid)
 {
+    if (actions == nullptr) {
+        return;
+    }
     std::shared_ptr<ResActionItem> header = nullptr;
     std::shared_ptr<ResActionItem> curItem = nullptr;
-    auto now = std::chrono::system_clock::now();
-    int64_t curMs = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+    int64_t curMs = SocPerfClock::GetInstance().NowMs();
     for (auto iter = actions->actionList.begin(); iter != actions->actionList.end(); iter++) {
         std::shared_ptr<Action> action = *iter;
         if (action->duration == 0 && onOff == EVENT_INVALID) {
@@ -414,16 +489,34 @@ void SocPerf::DoFreqActions(std::shared_ptr<Actions> actions, int32_t onOff, int
             }
             curItem = resActionItem;
         }
-        if (action->thermalCmdId_ != INVALID_THERMAL_CMD_ID && thermalLvl_ >= socPerfConfig_.minThermalLvl_) {
+        if (action->thermalCmdId_ != INVALID_THERMAL_CMD_ID) {
             curItem = DoPerfRequestThremalLvl(actions->id, action, onOff, curItem, endTime);
         }
     }
-    socperfThreadWrap_->DoFreqActionPack(header);
-    socperfThreadWrap_->PostDelayTask(header);
+    if (onOff == EVENT_ON && actions->maxHoldMs > 0) {
+        SetHoldWatchdog(header, actions->maxHoldMs, callerPid);
+    }
+    DispatchFreqActionPack(header);
+}
+
+void SocPerf::SetHoldWatchdog(std::shared_ptr<ResActionItem> head, int32_t maxHoldMs, int32_t callerPid)
+{
+    bool first = true;
+    for (std::shared_ptr<ResActionItem> item = head; item; item = item->next) {
+        if (item->resAction == nullptr || item->resAction->endTime != MAX_INT_VALUE) {
+            continue;
+        }
+        item->resAction->maxHoldMs = maxHoldMs;
+        item->resAction->callerPid = callerPid;
+        item->resAction->reportExpiry = first;
+        first = false;
+    }
 }
 
 void SocPerf::RequestDeviceMode(const std::string& mode, bool status)
 {
+    recorder_.Record(RECORD_ENTRY_REQUEST_DEVICE_MODE, 0, status, mode);
+    SocPerfLatencyScope latencyScope(RECORD_ENTRY_REQUEST_DEVICE_MODE, INVALID_CMD_ID);
     if (!enabled_) {
         SOC_PERF_LOGE("SocPerf disabled!");
         return;
@@ -457,38 +550,42 @@ void SocPerf::RequestDeviceMode(const std::string& mode, bool status)
     }
 
     const std::shared_ptr<SceneResNode> sceneResNode = iter->second;
-    const std::vector<std::shared_ptr<SceneItem>> items = sceneResNode->items;
     const int32_t persistMode = sceneResNode->persistMode;
 
-    const std::string modeStr = MatchDeviceMode(modeName, status, items);
+    const std::string modeStr = MatchDeviceMode(modeName, status, sceneResNode);
     if (persistMode == REPORT_TO_PERFSO && socPerfConfig_.scenarioFunc_) {
-        const std::string msgStr = modeType + ":" + modeStr;
-        SOC_PERF_LOGD("send deviceMode to PerfScenario : %{public}s", msgStr.c_str());
-        socPerfConfig_.scenarioFunc_(msgStr);
+        socperfThreadWrap_->PostScenario(modeType, modeStr);
     }
 }
 
 std::string SocPerf::MatchDeviceMode(const std::string& mode, bool status,
-    const std::vector<std::shared_ptr<SceneItem>>& items)
+    std::shared_ptr<SceneResNode> sceneResNode)
 {
-    std::lock_guard<std::mutex> lock(mutexDeviceMode_);
-
+    uint64_t modeBit = socPerfConfig_.GetDeviceModeBit(mode);
     if (!status) {
-        recordDeviceMode_.erase(mode);
+        if ((deviceModeMask_.fetch_and(~modeBit) & modeBit) != 0) {
+            UpdateActiveActionsInfo();
+        }
         return DEFAULT_MODE;
     }
 
     std::string itemName = DEFAULT_MODE;
-    for (const auto& iter : items) {
+    uint64_t matchBit = 0;
+    for (const auto& iter : sceneResNode->items) {
         if (iter->name == mode) {
-            recordDeviceMode_.insert(mode);
+            matchBit = iter->modeBit;
             if (iter->req == REPORT_TO_PERFSO) {
                 itemName = mode;
             }
-        } else {
-            recordDeviceMode_.erase(iter->name);
         }
     }
+    // the other modes of this type are switched off together
+    uint64_t modeMask = deviceModeMask_.load();
+    while (!deviceModeMask_.compare_exchange_weak(modeMask, (modeMask & ~sceneResNode->modeMask) | matchBit)) {
+    }
+    if (((modeMask & ~sceneResNode->modeMask) | matchBit) != modeMask) {
+        UpdateActiveActionsInfo();
+    }
     return itemName;
 }
 
@@ -508,13 +605,13 @@ int32_t SocPerf::MatchDeviceModeCmd(int32_t cmdId, bool isTagOnOff)
         return cmdId;
     }
 
-    std::lock_guard<std::mutex> lock(mutexDeviceMode_);
-    if (recordDeviceMode_.empty()) {
+    uint64_t activeMask = deviceModeMask_.load(std::memory_order_relaxed) & itrActions->second->modeMask;
+    if (activeMask == 0) {
         return cmdId;
     }
 
     for (const auto& iter : itrActions->second->modeMap) {
-        if (recordDeviceMode_.find(iter->mode) != recordDeviceMode_.end()) {
+        if ((activeMask & iter->modeBit) != 0) {
             int32_t deviceCmdId = iter->cmdId;
             auto itrDeviceCmdId = itrPerfActionsInfo->second.find(deviceCmdId);
             if (itrDeviceCmdId == itrPerfActionsInfo->second.end()) {
@@ -553,25 +650,18 @@ std::string SocPerf::RequestCmdIdCount(const std::string &msg)
     return ret.str();
 }
 
-std::string SocPerf::GetDeviceMode()
+void SocPerf::UpdateActiveActionsInfo()
 {
-    std::lock_guard<std::mutex> lock(mutexDeviceMode_);
-    if (recordDeviceMode_.empty()) {
-        return DEFAULT_CONFIG_MODE;
-    }
-    return *recordDeviceMode_.begin();
+    // the mask is read under the lock, the last rebuild always reflects the last mode change
+    std::lock_guard<std::mutex> lock(mutexActionsInfo_);
+    std::atomic_store(&activeActionsInfo_, socPerfConfig_.BuildActionsTable(deviceModeMask_.load()));
 }
 
 int32_t SocPerf::GetMatchCmdId(int32_t cmdId, bool isTagOnOff)
 {
     int32_t matchCmdId = INVALID_CMD_ID;
-    std::string matchMode = GetDeviceMode();
-    if ((socPerfConfig_.configPerfActionsInfo_.find(matchMode) ==
-        socPerfConfig_.configPerfActionsInfo_.end() ||
-        socPerfConfig_.configPerfActionsInfo_[matchMode].find(cmdId) ==
-        socPerfConfig_.configPerfActionsInfo_[matchMode].end()) &&
-        socPerfConfig_.configPerfActionsInfo_[DEFAULT_CONFIG_MODE].find(cmdId) ==
-        socPerfConfig_.configPerfActionsInfo_[DEFAULT_CONFIG_MODE].end()) {
+    auto actionsInfo = std::atomic_load(&activeActionsInfo_);
+    if (actionsInfo == nullptr || actionsInfo->find(cmdId) == actionsInfo->end()) {
         return matchCmdId;
     }
     matchCmdId = cmdId;
@@ -585,22 +675,18 @@ int32_t SocPerf::GetMatchCmdId(int32_t cmdId, bool isTagOnOff)
 
 std::shared_ptr<Actions> SocPerf::GetActionsInfo(int32_t cmdId)
 {
-    std::string matchMode = GetDeviceMode();
-    if (socPerfConfig_.configPerfActionsInfo_.find(matchMode) !=
-        socPerfConfig_.configPerfActionsInfo_.end() &&
-        socPerfConfig_.configPerfActionsInfo_[matchMode].find(cmdId) !=
-        socPerfConfig_.configPerfActionsInfo_[matchMode].end()) {
-        return socPerfConfig_.configPerfActionsInfo_[matchMode][cmdId];
+    auto actionsInfo = std::atomic_load(&activeActionsInfo_);
+    if (actionsInfo == nullptr) {
+        return nullptr;
     }
-    return socPerfConfig_.configPerfActionsInfo_[DEFAULT_CONFIG_MODE][cmdId];
+    auto iter = actionsInfo->find(cmdId);
+    return iter == actionsInfo->end() ? nullptr : iter->second;
 }
 
 bool SocPerf::CheckTimeInterval(bool onOff, int32_t cmdId)
 {
     std::lock_guard<std::mutex> lock(mutexBoostTime_);
-    auto now = std::chrono::system_clock::now();
-    uint64_t curMs = static_cast<uint64_t>(
-        std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count());
+    uint64_t curMs = static_cast<uint64_t>(SocPerfClock::GetInstance().NowMs());
     int32_t cancelCmdId = cmdId + CANCEL_CMDID_PREFIX;
     int32_t recordCmdId = cmdId;
     if (onOff) {
@@ -652,6 +738,143 @@ void SocPerf::ReportCmdIdStatistics()
                     "STATISTICS_INFO", statisticsInfo.str());
 }
  
+void SocPerf::StartRecord()
+{
+    recorder_.Start();
+}
+
+void SocPerf::StopRecord()
+{
+    recorder_.Stop();
+}
+
+std::string SocPerf::GetStateInfo()
+{
+    if (!enabled_) {
+        return "socperf is not initialized\n";
+    }
+    // every worker takes its snapshot ahead of its backlog and in parallel, a busy queue does not stall the dump
+    std::vector<SocPerfStateSnapshot> snapshots(socperfThreadWraps_.size());
+    std::vector<ffrt::task_handle> handles;
+    for (size_t i = 0; i < socperfThreadWraps_.size(); i++) {
+        handles.push_back(socperfThreadWraps_[i]->PostStateSnapshot(snapshots[i], true));
+    }
+    for (size_t i = 0; i < socperfThreadWraps_.size(); i++) {
+        socperfThreadWraps_[i]->WaitStateSnapshot(handles[i]);
+    }
+    SocPerfStateSnapshot& snapshot = snapshots[0];
+    for (size_t i = 1; i < snapshots.size(); i++) {
+        const SocPerfStateSnapshot& workerSnapshot = snapshots[i];
+        snapshot.queueWaitUs = std::max(snapshot.queueWaitUs, workerSnapshot.queueWaitUs);
+        snapshot.resStatus.insert(workerSnapshot.resStatus.begin(), workerSnapshot.resStatus.end());
+        for (const auto& item : workerSnapshot.perfHolds) {
+            snapshot.perfHolds[item.first] += item.second;
+        }
+        for (const auto& item : workerSnapshot.holdLeaks) {
+            snapshot.holdLeaks[item.first] += item.second;
+        }
+        for (const auto& client : workerSnapshot.limitRequests) {
+            snapshot.limitRequests[client.first].insert(client.second.begin(), client.second.end());
+        }
+    }
+    std::string result;
+    result.append("enabled: ").append(std::to_string(perfRequestEnable_))
+        .append(", snapshot queue wait: ").append(std::to_string(snapshot.queueWaitUs)).append("us\n");
+    result.append("power limit: ").append(std::to_string(snapshot.powerLimitBoost))
+        .append(" (battery ").append(std::to_string(batteryLimitStatus_))
+        .append(", power ").append(std::to_string(powerLimitStatus_)).append(")")
+        .append(", thermal limit: ").append(std::to_string(snapshot.thermalLimitBoost))
+        .append(", thermal level: ").append(std::to_string(snapshot.thermalLvl)).append("\n");
+    result.append("weak interaction: ").append(std::to_string(snapshot.weakInteractionStatus))
+        .append(", performance mode: ").append(std::to_string(snapshot.performanceModeStatus));
+    for (const auto& interAction : snapshot.interActionStatus) {
+        result.append(", cmdId ").append(std::to_string(interAction.first))
+            .append(" status ").append(std::to_string(interAction.second));
+    }
+    result.append("\nperf holds:");
+    for (const auto& item : snapshot.perfHolds) {
+        result.append(" ").append(std::to_string(item.first)).append("=").append(std::to_string(item.second));
+    }
+    result.append("\nhold leaks:");
+    for (const auto& item : snapshot.holdLeaks) {
+        result.append(" ").append(std::to_string(item.first)).append("=").append(std::to_string(item.second));
+    }
+    result.append("\ndevice modes:");
+    uint64_t modeMask = deviceModeMask_.load();
+    for (int32_t modeId = 0; modeId < (int32_t)socPerfConfig_.deviceModes_.size(); modeId++) {
+        if ((modeMask & (1ULL << modeId)) != 0) {
+            result.append(" ").append(socPerfConfig_.deviceModes_[modeId]);
+        }
+    }
+    result.append("\nlimit requests:\n");
+    for (const auto& client : snapshot.limitRequests) {
+        if (client.first < 0 || client.first >= (int32_t)ACTION_TYPE_MAX) {
+            continue;
+        }
+        result.append("    ").append(ACTION_TYPE_NAMES[client.first]).append(":");
+        for (const auto& item : client.second) {
+            result.append(" ").append(std::to_string(item.first)).append("=").append(std::to_string(item.second));
+        }
+        result.append("\n");
+    }
+    result.append("resources:\n");
+    for (const auto& item : snapshot.resStatus) {
+        const ResStatus& resStatus = item.second;
+        auto nodeIter = socPerfConfig_.resourceNodeInfo_.find(item.first);
+        result.append("    ").append(std::to_string(item.first)).append(" ")
+            .append(nodeIter != socPerfConfig_.resourceNodeInfo_.end() ? nodeIter->second->name : "")
+            .append(" candidate ").append(std::to_string(resStatus.candidate))
+            .append(" current ").append(std::to_string(resStatus.currentValue))
+            .append("/").append(FormatRemainTime(resStatus.currentEndTime, snapshot.takenMs))
+            .append(" previous ").append(std::to_string(resStatus.previousValue))
+            .append("/").append(FormatRemainTime(resStatus.previousEndTime, snapshot.takenMs)).append("\n");
+        // battery limits are folded into power, the battery slot of ResStatus is never used
+        for (int32_t type = ACTION_TYPE_PERF; type <= (int32_t)ACTION_TYPE_PERFLVL; type++) {
+            if (resStatus.resActionList[type].empty() && resStatus.candidatesValue[type] == INVALID_VALUE) {
+                continue;
+            }
+            result.append("        ").append(ACTION_TYPE_NAMES[type])
+                .append(" candidate ").append(std::to_string(resStatus.candidatesValue[type]))
+                .append("/").append(FormatRemainTime(resStatus.candidatesEndTime[type], snapshot.takenMs))
+                .append(":");
+            for (const auto& resAction : resStatus.resActionList[type]) {
+                result.append(" [cmdId ").append(std::to_string(resAction->cmdId))
+                    .append(" value ").append(std::to_string(resAction->value))
+                    .append(" onOff ").append(std::to_string(resAction->onOff))
+                    .append(" ").append(FormatRemainTime(resAction->endTime, snapshot.takenMs)).append("]");
+            }
+            result.append("\n");
+        }
+    }
+    return result;
+}
+
+std::string SocPerf::GetQueueInfo()
+{
+    if (!enabled_) {
+        return "socperf is not initialized\n";
+    }
+    if (socperfThreadWraps_.size() == 1) {
+        return socperfThreadWrap_->GetQueueStatsInfo();
+    }
+    std::string result;
+    for (size_t i = 0; i < socperfThreadWraps_.size(); i++) {
+        result.append("worker ").append(std::to_string(i)).append(":\n")
+            .append(socperfThreadWraps_[i]->GetQueueStatsInfo());
+    }
+    return result;
+}
+
+std::string SocPerf::GetLatencyInfo()
+{
+    return SocPerfLatency::GetInstance().Dump();
+}
+
+std::string SocPerf::GetRecordHex()
+{
+    return SocPerfRecorder::ToHex(recorder_.GetData());
+}
+
 void SocPerf::StartStatisticsTimer()
 {
     std::lock_guard<std::recursive_mutex> lock(mutexStatisticsTimer_);
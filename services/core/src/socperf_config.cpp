@@ -17,6 +17,10 @@
 #include <algorithm>
 #include <chrono>
 #include <dlfcn.h>
+#include <functional>
+#include <queue>
+#include <set>
+#include <unordered_set>
  
 #include "config_policy_utils.h"
 #include "parameters.h"
@@ -32,6 +36,7 @@ namespace {
     void* g_handle;
     const std::string SPLIT_OR = "|";
     const std::string SPLIT_EQUAL = "=";
+    const std::string SPLIT_COMMA = ",";
     const std::string SPLIT_SPACE = " ";
 }
 
@@ -63,6 +68,11 @@ bool SocPerfConfig::Init()
         return false;
     }
 
+    if (!BuildConstraintDomains()) {
+        SOC_PERF_LOGE("Failed to build constraint domains");
+        return false;
+    }
+
     if (!LoadAllConfigXmlFile(resourceConfigXml)) {
         SOC_PERF_LOGE("Failed to load %{private}s", resourceConfigXml.c_str());
         return false;
@@ -71,6 +81,7 @@ bool SocPerfConfig::Init()
     if (!LoadAllConfigXmlFile(CAMERA_AWARE_CONFIG_XML)) {
         SOC_PERF_LOGE("Failed to load %{private}s", CAMERA_AWARE_CONFIG_XML.c_str());
     }
+    BuildDeviceModes();
 
     g_resStrToIdInfo.clear();
     g_resStrToIdInfo = std::unordered_map<std::string, int32_t>();
@@ -239,6 +250,10 @@ bool SocPerfConfig::ParseResourceXmlFile(const xmlNode* rootNode, const std::str
             LoadSceneResource(child, realConfigFile);
         } else if (!xmlStrcmp(child->name, reinterpret_cast<const xmlChar*>("Info"))) {
             LoadInfo(child, realConfigFile);
+        } else if (!xmlStrcmp(child->name, reinterpret_cast<const xmlChar*>("Constraint"))) {
+            if (!LoadConstraint(child, realConfigFile)) {
+                return false;
+            }
         }
     }
     return true;
@@ -246,6 +261,12 @@ bool SocPerfConfig::ParseResourceXmlFile(const xmlNode* rootNode, const std::str
 
 bool SocPerfConfig::LoadResource(xmlNode* child, const std::string& configFile)
 {
+    int32_t workerCnt = GetXmlIntProp(child, "workers", workerCnt_);
+    if (workerCnt < 1 || workerCnt > MAX_WORKER_CNT) {
+        SOC_PERF_LOGE("Invalid workers %{public}d for %{private}s", workerCnt, configFile.c_str());
+        return false;
+    }
+    workerCnt_ = workerCnt;
     xmlNode* grandson = child->children;
     for (; grandson; grandson = grandson->next) {
         if (!xmlStrcmp(grandson->name, reinterpret_cast<const xmlChar*>("res"))) {
@@ -270,6 +291,31 @@ bool SocPerfConfig::CheckTrace(const char* trace)
     return false;
 }
 
+bool SocPerfConfig::CheckReadBack(const char* readBack)
+{
+    if (readBack && IsNumber(readBack) && atoi(readBack) == PERF_OPEN_READ_BACK) {
+        return true;
+    }
+    return false;
+}
+
+bool SocPerfConfig::ParseSnapMode(const char* snap, int32_t& snapMode) const
+{
+    if (!snap) {
+        snapMode = SNAP_MODE_NONE;
+    } else if (SNAP_MODE_FLOOR_STR == snap) {
+        snapMode = SNAP_MODE_FLOOR;
+    } else if (SNAP_MODE_CEIL_STR == snap) {
+        snapMode = SNAP_MODE_CEIL;
+    } else if (SNAP_MODE_NEAREST_STR == snap) {
+        snapMode = SNAP_MODE_NEAREST;
+    } else {
+        SOC_PERF_LOGE("Invalid resource snap mode %{public}s", snap);
+        return false;
+    }
+    return true;
+}
+
 bool SocPerfConfig::TraversalFreqResource(xmlNode* grandson, const std::string& configFile)
 {
     char* id = reinterpret_cast<char*>(xmlGetProp(grandson, reinterpret_cast<const xmlChar*>("id")));
@@ -278,13 +324,18 @@ bool SocPerfConfig::TraversalFreqResource(xmlNode* grandson, const std::string&
     char* mode = reinterpret_cast<char*>(xmlGetProp(grandson, reinterpret_cast<const xmlChar*>("mode")));
     char* persistMode = reinterpret_cast<char*>(xmlGetProp(grandson, reinterpret_cast<const xmlChar*>("switch")));
     char* trace = reinterpret_cast<char*>(xmlGetProp(grandson, reinterpret_cast<const xmlChar*>("trace")));
-    if (!CheckResourceTag(id, name, pair, mode, persistMode, configFile)) {
+    char* readBack = reinterpret_cast<char*>(xmlGetProp(grandson, reinterpret_cast<const xmlChar*>("readback")));
+    char* snap = reinterpret_cast<char*>(xmlGetProp(grandson, reinterpret_cast<const xmlChar*>("snap")));
+    int32_t snapMode = SNAP_MODE_NONE;
+    if (!CheckResourceTag(id, name, pair, mode, persistMode, configFile) || !ParseSnapMode(snap, snapMode)) {
         xmlFree(id);
         xmlFree(name);
         xmlFree(pair);
         xmlFree(mode);
         xmlFree(persistMode);
         xmlFree(trace);
+        xmlFree(readBack);
+        xmlFree(snap);
         return false;
     }
     auto it = resourceNodeInfo_.find(atoi(id));
@@ -295,17 +346,23 @@ bool SocPerfConfig::TraversalFreqResource(xmlNode* grandson, const std::string&
         xmlFree(mode);
         xmlFree(persistMode);
         xmlFree(trace);
+        xmlFree(readBack);
+        xmlFree(snap);
         return true;
     }
     xmlNode* greatGrandson = grandson->children;
     std::shared_ptr<ResNode> resNode = std::make_shared<ResNode>(atoi(id), name, mode ? atoi(mode) : 0,
         pair ? atoi(pair) : INVALID_VALUE, persistMode ? atoi(persistMode) : 0);
     resNode->trace = CheckTrace(trace);
+    resNode->readBack = CheckReadBack(readBack);
+    resNode->snapMode = snapMode;
     xmlFree(id);
     xmlFree(name);
     xmlFree(pair);
     xmlFree(mode);
     xmlFree(trace);
+    xmlFree(readBack);
+    xmlFree(snap);
     if (!LoadFreqResourceContent(persistMode ? atoi(persistMode) : 0, greatGrandson, configFile, resNode)) {
         xmlFree(persistMode);
         return false;
@@ -446,6 +503,118 @@ void SocPerfConfig::LoadInterAction(xmlNode* child, const std::string& configFil
     }
 }
 
+void SocPerfConfig::LoadRateLimit(xmlNode* child, const std::string& configFile)
+{
+    boostBudgetWindowMs_ = GetXmlIntProp(child, "window", 0);
+    boostBudgetMs_ = GetXmlIntProp(child, "budget", 0);
+    xmlNode* grandson = child->children;
+    for (; grandson; grandson = grandson->next) {
+        if (xmlStrcmp(grandson->name, reinterpret_cast<const xmlChar*>("class"))) {
+            continue;
+        }
+        auto rateLimitClass = std::make_shared<RateLimitClass>();
+        char* name = reinterpret_cast<char*>(xmlGetProp(grandson, reinterpret_cast<const xmlChar*>("name")));
+        if (name) {
+            rateLimitClass->name = name;
+            xmlFree(name);
+        }
+        rateLimitClass->rate = GetXmlIntProp(grandson, "rate", 0);
+        rateLimitClass->burst = GetXmlIntProp(grandson, "burst", rateLimitClass->rate);
+        if (rateLimitClass->rate <= 0 || rateLimitClass->burst <= 0) {
+            SOC_PERF_LOGW("Invalid rate limit class %{public}s for %{private}s",
+                rateLimitClass->name.c_str(), configFile.c_str());
+            continue;
+        }
+        char* cmds = reinterpret_cast<char*>(xmlGetProp(grandson, reinterpret_cast<const xmlChar*>("cmds")));
+        if (cmds) {
+            for (const std::string& cmdId : Split(cmds, SPLIT_COMMA)) {
+                if (IsNumber(cmdId)) {
+                    rateLimitClass->cmdIds.push_back(atoi(cmdId.c_str()));
+                }
+            }
+            xmlFree(cmds);
+        }
+        rateLimitClasses_.push_back(rateLimitClass);
+    }
+}
+
+void SocPerfConfig::BuildDeviceModes()
+{
+    std::set<std::string> modes;
+    for (const auto& scene : sceneResourceInfo_) {
+        for (const auto& item : scene.second->items) {
+            modes.insert(item->name);
+        }
+    }
+    deviceModes_.clear();
+    deviceModeIds_.clear();
+    for (const std::string& mode : modes) {
+        if ((int32_t)deviceModes_.size() >= MAX_DEVICE_MODE_CNT) {
+            SOC_PERF_LOGE("Too many device modes, %{public}s is ignored", mode.c_str());
+            continue;
+        }
+        deviceModeIds_[mode] = (int32_t)deviceModes_.size();
+        deviceModes_.push_back(mode);
+    }
+    for (const auto& scene : sceneResourceInfo_) {
+        scene.second->modeMask = 0;
+        for (const auto& item : scene.second->items) {
+            item->modeBit = GetDeviceModeBit(item->name);
+            scene.second->modeMask |= item->modeBit;
+        }
+    }
+    configModeOrder_.clear();
+    for (const auto& perfActionsInfo : configPerfActionsInfo_) {
+        if (perfActionsInfo.first != DEFAULT_CONFIG_MODE && GetDeviceModeBit(perfActionsInfo.first) != 0) {
+            configModeOrder_.push_back(perfActionsInfo.first);
+        }
+    }
+    std::sort(configModeOrder_.begin(), configModeOrder_.end(), [this](const std::string& a, const std::string& b) {
+        int32_t priorityA = configModePriority_.count(a) > 0 ? configModePriority_.at(a) : 0;
+        int32_t priorityB = configModePriority_.count(b) > 0 ? configModePriority_.at(b) : 0;
+        return priorityA != priorityB ? priorityA < priorityB : a > b;
+    });
+    for (const auto& perfActionsInfo : configPerfActionsInfo_) {
+        for (const auto& actions : perfActionsInfo.second) {
+            actions.second->modeMask = 0;
+            for (const auto& modeMap : actions.second->modeMap) {
+                modeMap->modeBit = GetDeviceModeBit(modeMap->mode);
+                actions.second->modeMask |= modeMap->modeBit;
+            }
+        }
+    }
+}
+
+uint64_t SocPerfConfig::GetDeviceModeBit(const std::string& mode) const
+{
+    auto iter = deviceModeIds_.find(mode);
+    if (iter == deviceModeIds_.end()) {
+        return 0;
+    }
+    return 1ULL << iter->second;
+}
+
+std::shared_ptr<std::unordered_map<int32_t, std::shared_ptr<Actions>>> SocPerfConfig::BuildActionsTable(
+    uint64_t modeMask) const
+{
+    auto actionsTable = std::make_shared<std::unordered_map<int32_t, std::shared_ptr<Actions>>>();
+    auto defaultIter = configPerfActionsInfo_.find(DEFAULT_CONFIG_MODE);
+    if (defaultIter != configPerfActionsInfo_.end()) {
+        *actionsTable = defaultIter->second;
+    }
+    // later layers win, so the highest priority active mode is applied last
+    for (const std::string& mode : configModeOrder_) {
+        auto iter = configPerfActionsInfo_.find(mode);
+        if ((modeMask & GetDeviceModeBit(mode)) == 0 || iter == configPerfActionsInfo_.end()) {
+            continue;
+        }
+        for (const auto& actions : iter->second) {
+            (*actionsTable)[actions.first] = actions.second;
+        }
+    }
+    return actionsTable;
+}
+
 bool SocPerfConfig::LoadSceneResource(xmlNode* child, const std::string& configFile)
 {
     xmlNode* grandson = child->children;
@@ -593,6 +762,7 @@ bool SocPerfConfig::HandleConfigNode(const xmlNode* configNode, const std::strin
             if (configMode.empty()) {
                 configMode = DEFAULT_CONFIG_MODE;
             }
+            configModePriority_[configMode] = GetXmlIntProp(configNode, "priority", 0);
             if (!LoadConfigInfo(configNode, configFile, configMode)) {
                 return false;
             }
@@ -635,6 +805,9 @@ bool SocPerfConfig::LoadConfigInfo(const xmlNode* configNode, const std::string&
             }
         } else if (!xmlStrcmp(child->name, reinterpret_cast<const xmlChar*>("interaction"))) {
             LoadInterAction(child, configFile);
+        } else if (!xmlStrcmp(child->name, reinterpret_cast<const xmlChar*>("rateLimit")) &&
+            configMode == DEFAULT_CONFIG_MODE) {
+            LoadRateLimit(child, configFile);
         }
     }
     return true;
@@ -676,6 +849,8 @@ bool SocPerfConfig::LoadCmdInfo(const xmlNode* child, const std::string& configF
         xmlFree(interaction);
     }
 
+    actions->maxHoldMs = GetXmlIntProp(child, "maxHold", 0);
+
     char* mode = reinterpret_cast<char*>(xmlGetProp(child, reinterpret_cast<const xmlChar*>("mode")));
     if (mode) {
         if (configMode == DEFAULT_CONFIG_MODE) {
@@ -687,6 +862,7 @@ bool SocPerfConfig::LoadCmdInfo(const xmlNode* child, const std::string& configF
     if (!TraversalBoostResource(grandson, configFile, actions)) {
         return false;
     }
+    BuildThermalLvlTable(actions);
 
     perfActionsInfo.insert(std::pair<int32_t, std::shared_ptr<Actions>>(actions->id, actions));
     configPerfActionsInfo_[configMode] = perfActionsInfo;
@@ -784,6 +960,10 @@ bool SocPerfConfig::TraversalBoostResource(xmlNode* grandson,
     for (; grandson; grandson = grandson->next) { // Iterate all Action
         std::shared_ptr<Action> action = std::make_shared<Action>();
         action->thermalLvl_ = GetXmlIntProp(grandson, "thermalLvl", INVALID_THERMAL_LVL);
+        if (action->thermalLvl_ < INVALID_THERMAL_LVL || action->thermalLvl_ > MAX_THERMAL_LVL) {
+            SOC_PERF_LOGE("Invalid thermalLvl %{public}d for %{private}s", action->thermalLvl_, configFile.c_str());
+            return false;
+        }
         if (action->thermalLvl_ != INVALID_THERMAL_LVL) {
             if (minThermalLvl_ == INVALID_THERMAL_LVL || minThermalLvl_ > action->thermalLvl_) {
                 minThermalLvl_ = action->thermalLvl_;
@@ -809,6 +989,49 @@ bool SocPerfConfig::TraversalBoostResource(xmlNode* grandson,
     return true;
 }
 
+void SocPerfConfig::BuildThermalLvlTable(std::shared_ptr<Actions> actions) const
+{
+    actions->thermalResIds.clear();
+    actions->thermalLvlValues.clear();
+    if (actions->actionList.empty()) {
+        return;
+    }
+    std::set<int32_t> resIds;
+    int32_t minLvl = MAX_THERMAL_LVL;
+    int32_t maxLvl = INVALID_THERMAL_LVL;
+    for (const auto& action : actions->actionList) {
+        minLvl = std::min(minLvl, action->thermalLvl_);
+        maxLvl = std::max(maxLvl, action->thermalLvl_);
+        for (int32_t i = 0; i < (int32_t)action->variable.size() - 1; i += RES_ID_AND_VALUE_PAIR) {
+            if (IsValidResId(action->variable[i])) {
+                resIds.insert(action->variable[i]);
+            }
+        }
+    }
+    // a level takes the nearest action at or below it, the later one of the same level wins
+    std::vector<std::shared_ptr<Action>> selected(maxLvl - minLvl + 1);
+    for (const auto& action : actions->actionList) {
+        selected[action->thermalLvl_ - minLvl] = action;
+    }
+    actions->thermalResIds.assign(resIds.begin(), resIds.end());
+    actions->thermalLvlBase = minLvl;
+    actions->thermalLvlValues.assign(selected.size(), std::vector<int64_t>(resIds.size(), INVALID_VALUE));
+    for (size_t row = 0; row < selected.size(); row++) {
+        if (selected[row] == nullptr) {
+            selected[row] = selected[row - 1];
+        }
+        const std::vector<int64_t>& variable = selected[row]->variable;
+        for (int32_t i = 0; i < (int32_t)variable.size() - 1; i += RES_ID_AND_VALUE_PAIR) {
+            auto iter = std::lower_bound(actions->thermalResIds.begin(), actions->thermalResIds.end(), variable[i]);
+            if (iter == actions->thermalResIds.end() || *iter != variable[i]) {
+                continue;
+            }
+            int64_t& value = actions->thermalLvlValues[row][iter - actions->thermalResIds.begin()];
+            value = std::max(value, variable[i + 1]);
+        }
+    }
+}
+
 bool SocPerfConfig::CheckResourceTag(const char* id, const char* name, const char* pair, const char* mode,
     const char* persistMode, const std::string& configFile) const
 {
@@ -860,7 +1083,7 @@ bool SocPerfConfig::LoadResourceAvailable(std::shared_ptr<ResNode> resNode, cons
     std::vector<std::string> result = Split(nodeStr, SPLIT_SPACE);
     for (auto str : result) {
         if (IsNumber(str)) {
-            resNode->available.insert(atoll(str.c_str()));
+            resNode->AddAvailable(atoll(str.c_str()));
         } else {
             return false;
         }
@@ -891,7 +1114,7 @@ bool SocPerfConfig::CheckDefValid() const
         int32_t resId = iter->first;
         std::shared_ptr<ResourceNode> resourceNode = iter->second;
         int64_t def = resourceNode->def;
-        if (!resourceNode->available.empty() && resourceNode->available.find(def) == resourceNode->available.end()) {
+        if (!resourceNode->available.empty() && !resourceNode->IsAvailable(def)) {
             SOC_PERF_LOGE("resId[%{public}d]'s def[%{public}lld] is not valid", resId, (long long)def);
             return false;
         }
@@ -920,7 +1143,7 @@ bool SocPerfConfig::CheckGovResourceTag(const char* id, const char* name,
 bool SocPerfConfig::LoadGovResourceAvailable(std::shared_ptr<GovResNode> govResNode,
     const char* level, const char* node)
 {
-    govResNode->available.insert(atoll(level));
+    govResNode->AddAvailable(atoll(level));
     std::string nodeStr = node;
     std::vector<std::string> result = Split(nodeStr, SPLIT_OR);
     if (result.size() != govResNode->paths.size()) {
@@ -951,8 +1174,8 @@ bool SocPerfConfig::TraversalActions(std::shared_ptr<Action> action, int32_t act
         int64_t resValue = action->variable[i + 1];
         if (resourceNodeInfo_.find(resId) != resourceNodeInfo_.end() && resourceNodeInfo_[resId] != nullptr) {
             if (resourceNodeInfo_[resId]->persistMode != REPORT_TO_PERFSO &&
-                !resourceNodeInfo_[resId]->available.empty() &&
-                resourceNodeInfo_[resId]->available.find(resValue) == resourceNodeInfo_[resId]->available.end()) {
+                resourceNodeInfo_[resId]->snapMode == SNAP_MODE_NONE &&
+                !resourceNodeInfo_[resId]->available.empty() && !resourceNodeInfo_[resId]->IsAvailable(resValue)) {
                 SOC_PERF_LOGE("action[%{public}d]'s resValue[%{public}lld] is not valid",
                     actionId, (long long)resValue);
                 return false;
@@ -993,6 +1216,312 @@ bool SocPerfConfig::CheckActionsValid(std::unordered_map<int32_t, std::shared_pt
     return true;
 }
 
+bool SocPerfConfig::LoadConstraint(xmlNode* child, const std::string& configFile)
+{
+    xmlNode* grandson = child->children;
+    for (; grandson; grandson = grandson->next) {
+        if (xmlStrcmp(grandson->name, reinterpret_cast<const xmlChar*>("group"))) {
+            continue;
+        }
+        if (!TraversalConstraintGroup(grandson, configFile)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SocPerfConfig::TraversalConstraintGroup(xmlNode* grandson, const std::string& configFile)
+{
+    char* name = reinterpret_cast<char*>(xmlGetProp(grandson, reinterpret_cast<const xmlChar*>("name")));
+    char* type = reinterpret_cast<char*>(xmlGetProp(grandson, reinterpret_cast<const xmlChar*>("type")));
+    char* res = reinterpret_cast<char*>(xmlGetProp(grandson, reinterpret_cast<const xmlChar*>("res")));
+    if (!CheckConstraintGroupTag(name, type, res, configFile)) {
+        xmlFree(name);
+        xmlFree(type);
+        xmlFree(res);
+        return false;
+    }
+    auto it = std::find_if(constraintGroups_.begin(), constraintGroups_.end(),
+        [name](const std::shared_ptr<ConstraintGroup>& group) { return group->name == name; });
+    if (it != constraintGroups_.end()) {
+        xmlFree(name);
+        xmlFree(type);
+        xmlFree(res);
+        return true;
+    }
+    std::shared_ptr<ConstraintGroup> group = std::make_shared<ConstraintGroup>(name,
+        CONSTRAINT_TYPE_FOLLOW_STR == type ? CONSTRAINT_TYPE_FOLLOW : CONSTRAINT_TYPE_ORDER);
+    std::vector<std::string> resStrs = Split(res, SPLIT_OR);
+    for (const auto& resStr : resStrs) {
+        group->resIds.push_back(atoi(resStr.c_str()));
+    }
+    xmlFree(name);
+    xmlFree(type);
+    xmlFree(res);
+    if (group->type == CONSTRAINT_TYPE_FOLLOW && !LoadConstraintFloorMap(grandson->children, configFile, group)) {
+        return false;
+    }
+    constraintGroups_.push_back(group);
+    return true;
+}
+
+bool SocPerfConfig::CheckConstraintGroupTag(const char* name, const char* type, const char* res,
+    const std::string& configFile) const
+{
+    if (!name || !res) {
+        SOC_PERF_LOGE("Invalid constraint group name/res for %{private}s", configFile.c_str());
+        return false;
+    }
+    if (type && CONSTRAINT_TYPE_ORDER_STR != type && CONSTRAINT_TYPE_FOLLOW_STR != type) {
+        SOC_PERF_LOGE("Invalid constraint group type for %{private}s", configFile.c_str());
+        return false;
+    }
+    std::vector<std::string> resStrs = Split(res, SPLIT_OR);
+    if ((int32_t)resStrs.size() < MIN_CONSTRAINT_GROUP_SIZE) {
+        SOC_PERF_LOGE("constraint group %{public}s needs at least two resources", name);
+        return false;
+    }
+    for (const auto& resStr : resStrs) {
+        if (!IsNumber(resStr)) {
+            SOC_PERF_LOGE("Invalid constraint group res for %{private}s", configFile.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SocPerfConfig::LoadConstraintFloorMap(xmlNode* greatGrandson, const std::string& configFile,
+    std::shared_ptr<ConstraintGroup> group)
+{
+    for (; greatGrandson; greatGrandson = greatGrandson->next) {
+        if (xmlStrcmp(greatGrandson->name, reinterpret_cast<const xmlChar*>("map"))) {
+            continue;
+        }
+        char* src = reinterpret_cast<char*>(xmlGetProp(greatGrandson, reinterpret_cast<const xmlChar*>("src")));
+        char* dst = reinterpret_cast<char*>(xmlGetProp(greatGrandson, reinterpret_cast<const xmlChar*>("dst")));
+        if (!src || !dst || !IsNumber(src) || !IsNumber(dst)) {
+            SOC_PERF_LOGE("Invalid constraint map for %{private}s", configFile.c_str());
+            xmlFree(src);
+            xmlFree(dst);
+            return false;
+        }
+        group->floorMap.push_back(std::make_pair(atoll(src), atoll(dst)));
+        xmlFree(src);
+        xmlFree(dst);
+    }
+    if (group->floorMap.empty()) {
+        SOC_PERF_LOGE("follow constraint group %{public}s has no map", group->name.c_str());
+        return false;
+    }
+    std::sort(group->floorMap.begin(), group->floorMap.end());
+    return true;
+}
+
+std::vector<std::shared_ptr<ConstraintGroup>> SocPerfConfig::GetPairConstraintGroups() const
+{
+    std::vector<std::shared_ptr<ConstraintGroup>> pairGroups;
+    for (auto iter = resourceNodeInfo_.begin(); iter != resourceNodeInfo_.end(); ++iter) {
+        if (iter->second->isGov) {
+            continue;
+        }
+        std::shared_ptr<ResNode> resNode = std::static_pointer_cast<ResNode>(iter->second);
+        auto pairIter = resourceNodeInfo_.find(resNode->pair);
+        if (resNode->pair == INVALID_VALUE || pairIter == resourceNodeInfo_.end()) {
+            continue;
+        }
+        // the pair is owned by its max side, a pair without max side has nothing to order
+        if (!resNode->isMaxValue) {
+            if (!pairIter->second->isMaxValue) {
+                SOC_PERF_LOGW("resId[%{public}d] and its pair have no max value", resNode->id);
+            }
+            continue;
+        }
+        std::shared_ptr<ConstraintGroup> group = std::make_shared<ConstraintGroup>(
+            "pair_" + std::to_string(resNode->pair) + "_" + std::to_string(resNode->id), CONSTRAINT_TYPE_ORDER);
+        group->resIds = { resNode->pair, resNode->id };
+        pairGroups.push_back(group);
+    }
+    return pairGroups;
+}
+
+bool SocPerfConfig::CheckConstraintGroupValid(std::shared_ptr<ConstraintGroup> group) const
+{
+    std::unordered_set<int32_t> resIds;
+    for (int32_t resId : group->resIds) {
+        if (!IsValidResId(resId) || IsGovResId(resId) || !resIds.insert(resId).second) {
+            SOC_PERF_LOGE("constraint group %{public}s has invalid resId[%{public}d]", group->name.c_str(), resId);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SocPerfConfig::BuildConstraintDomains()
+{
+    constraintDomains_.clear();
+    resConstraintDomain_.clear();
+    std::vector<std::shared_ptr<ConstraintGroup>> groups = GetPairConstraintGroups();
+    groups.insert(groups.end(), constraintGroups_.begin(), constraintGroups_.end());
+
+    // resources linked by any group have to be arbitrated together, so merge groups into connected domains
+    std::unordered_map<int32_t, int32_t> parent;
+    std::function<int32_t(int32_t)> findRoot = [&parent, &findRoot](int32_t resId) {
+        auto iter = parent.find(resId);
+        if (iter == parent.end() || iter->second == resId) {
+            return resId;
+        }
+        iter->second = findRoot(iter->second);
+        return iter->second;
+    };
+    for (const auto& group : groups) {
+        if (!CheckConstraintGroupValid(group)) {
+            return false;
+        }
+        int32_t root = findRoot(group->resIds[0]);
+        for (int32_t resId : group->resIds) {
+            parent[findRoot(resId)] = root;
+        }
+    }
+
+    std::unordered_map<int32_t, int32_t> rootDomain;
+    std::vector<std::vector<std::pair<int32_t, int32_t>>> domainEdges;
+    for (const auto& group : groups) {
+        int32_t root = findRoot(group->resIds[0]);
+        auto iter = rootDomain.find(root);
+        if (iter == rootDomain.end()) {
+            iter = rootDomain.insert(std::make_pair(root, (int32_t)constraintDomains_.size())).first;
+            constraintDomains_.push_back(std::make_shared<ConstraintDomain>());
+            domainEdges.emplace_back();
+        }
+        std::shared_ptr<ConstraintDomain> domain = constraintDomains_[iter->second];
+        for (size_t i = 0; i < group->resIds.size(); i++) {
+            if (resConstraintDomain_.insert(std::make_pair(group->resIds[i], iter->second)).second) {
+                domain->resIds.push_back(group->resIds[i]);
+                domain->hasMaxRes = domain->hasMaxRes || resourceNodeInfo_[group->resIds[i]]->isMaxValue;
+            }
+            if (group->type == CONSTRAINT_TYPE_ORDER && i > 0) {
+                domainEdges[iter->second].push_back(std::make_pair(group->resIds[i - 1], group->resIds[i]));
+            }
+        }
+        if (group->type == CONSTRAINT_TYPE_FOLLOW) {
+            domain->followGroups.push_back(group);
+        }
+    }
+    for (size_t i = 0; i < constraintDomains_.size(); i++) {
+        if (!SortConstraintDomain(constraintDomains_[i], domainEdges[i])) {
+            return false;
+        }
+    }
+    BuildWorkerDomains();
+    BuildResSlots();
+    return true;
+}
+
+void SocPerfConfig::BuildWorkerDomains()
+{
+    resWorker_.clear();
+    // a constraint domain is arbitrated as a whole, every other resource is independent
+    std::vector<std::vector<int32_t>> components;
+    for (const auto& domain : constraintDomains_) {
+        components.push_back(domain->resIds);
+        std::sort(components.back().begin(), components.back().end());
+    }
+    for (const auto& item : resourceNodeInfo_) {
+        if (resConstraintDomain_.find(item.first) == resConstraintDomain_.end()) {
+            components.push_back({ item.first });
+        }
+    }
+    std::sort(components.begin(), components.end(),
+        [](const std::vector<int32_t>& a, const std::vector<int32_t>& b) {
+        return a.size() != b.size() ? a.size() > b.size() : a.front() < b.front();
+    });
+    // largest first onto the least loaded worker keeps the shards balanced by resource count
+    std::vector<size_t> workerLoad(workerCnt_, 0);
+    for (const auto& component : components) {
+        int32_t workerId = (int32_t)(std::min_element(workerLoad.begin(), workerLoad.end()) - workerLoad.begin());
+        for (int32_t resId : component) {
+            resWorker_[resId] = workerId;
+        }
+        workerLoad[workerId] += component.size();
+    }
+}
+
+void SocPerfConfig::BuildResSlots()
+{
+    std::vector<int32_t> resIds;
+    for (const auto& item : resourceNodeInfo_) {
+        resIds.push_back(item.first);
+    }
+    std::sort(resIds.begin(), resIds.end());
+    resSlot_.assign(MAX_RESOURCE_ID - MIN_RESOURCE_ID + 1, INVALID_VALUE);
+    resSlotCnt_ = 0;
+    for (int32_t resId : resIds) {
+        if (resId >= MIN_RESOURCE_ID && resId <= MAX_RESOURCE_ID) {
+            resSlot_[resId - MIN_RESOURCE_ID] = resSlotCnt_++;
+        }
+    }
+}
+
+int32_t SocPerfConfig::GetResSlot(int32_t resId) const
+{
+    if (resId < MIN_RESOURCE_ID || resId > MAX_RESOURCE_ID || resSlot_.empty()) {
+        return INVALID_VALUE;
+    }
+    return resSlot_[resId - MIN_RESOURCE_ID];
+}
+
+int32_t SocPerfConfig::GetWorkerId(int32_t resId) const
+{
+    auto iter = resWorker_.find(resId > RES_ID_ADDITION ? resId - RES_ID_ADDITION : resId);
+    return iter == resWorker_.end() ? 0 : iter->second;
+}
+
+bool SocPerfConfig::SortConstraintDomain(std::shared_ptr<ConstraintDomain> domain,
+    const std::vector<std::pair<int32_t, int32_t>>& edges)
+{
+    std::unordered_map<int32_t, int32_t> inDegree;
+    std::unordered_map<int32_t, std::vector<int32_t>> uppers;
+    for (const auto& edge : edges) {
+        inDegree[edge.second]++;
+        uppers[edge.first].push_back(edge.second);
+    }
+    std::queue<int32_t> readyResIds;
+    for (int32_t resId : domain->resIds) {
+        if (inDegree[resId] == 0) {
+            readyResIds.push(resId);
+        }
+    }
+    std::vector<int32_t> sortedResIds;
+    std::unordered_map<int32_t, int32_t> rank;
+    while (!readyResIds.empty()) {
+        int32_t resId = readyResIds.front();
+        readyResIds.pop();
+        rank[resId] = (int32_t)sortedResIds.size();
+        sortedResIds.push_back(resId);
+        for (int32_t upper : uppers[resId]) {
+            if (--inDegree[upper] == 0) {
+                readyResIds.push(upper);
+            }
+        }
+    }
+    if (sortedResIds.size() != domain->resIds.size()) {
+        SOC_PERF_LOGE("order constraint groups of resId[%{public}d] contain a cycle", domain->resIds[0]);
+        return false;
+    }
+    domain->resIds = sortedResIds;
+    domain->raiseEdges = edges;
+    std::sort(domain->raiseEdges.begin(), domain->raiseEdges.end(),
+        [&rank](const std::pair<int32_t, int32_t>& a, const std::pair<int32_t, int32_t>& b) {
+            return rank[a.first] < rank[b.first];
+        });
+    domain->limitEdges = edges;
+    std::sort(domain->limitEdges.begin(), domain->limitEdges.end(),
+        [&rank](const std::pair<int32_t, int32_t>& a, const std::pair<int32_t, int32_t>& b) {
+            return rank[a.second] > rank[b.second];
+        });
+    return true;
+}
+
 void SocPerfConfig::ReportConfigLoadAbnormal(const std::string& configFile,
     const std::string& errorMsg, int32_t abnormalCode)
 {
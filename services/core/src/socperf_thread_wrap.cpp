@@ -14,24 +14,33 @@
  */
 #include "socperf_thread_wrap.h"
 
-#include <set>               // for set
-#include <unistd.h>          // for open, write
+#include <algorithm>         // for remove
+#include <unordered_set>     // for unordered_set
+#include <unistd.h>          // for open, read, write, close
 #include <fcntl.h>           // for O_RDWR, O_CLOEXEC
 
 #include "res_exe_type.h"
 #include "res_sched_exe_client.h"
 #include "socperf.h"
+#include "socperf_clock.h"
 #include "socperf_trace.h"
 
 namespace OHOS {
 namespace SOCPERF {
 
 namespace {
+    constexpr int32_t BATTERY_LIMIT_CMD_ID = -2;
+    constexpr int32_t LIMIT_SLOT_PLANES = 2;
     constexpr int32_t PERF_REQUEST_CMD_ID_WEAK_INTERACTION = 9101;
     constexpr int32_t PERF_REQUEST_CMD_ID_WEAK_INTERACTION_PERFORMANCE_MODE = 39101;
 }
 
-SocPerfThreadWrap::SocPerfThreadWrap() : socperfQueue_("socperf", ffrt::queue_attr().qos(ffrt::qos_user_interactive))
+// a concurrent queue limited to one worker keeps the serial semantics and honours task priorities
+SocPerfThreadWrap::SocPerfThreadWrap(int32_t workerId) : workerId_(workerId),
+    queueName_(workerId == 0 ? "socperf" : "socperf_" + std::to_string(workerId)),
+    socperfQueue_(ffrt::queue_concurrent, queueName_.c_str(),
+    ffrt::queue_attr().qos(ffrt::qos_user_interactive).max_concurrency(1)),
+    queueStats_((queueName_ + "_queue").c_str())
 {
 }
 
@@ -42,18 +51,29 @@ SocPerfThreadWrap::~SocPerfThreadWrap()
 void SocPerfThreadWrap::InitResourceNodeInfo()
 {
     std::function<void()>&& initResourceNodeInfoFunc = [this]() {
+        readBackResIds_.clear();
         for (auto iter = socPerfConfig_.resourceNodeInfo_.begin();
             iter != socPerfConfig_.resourceNodeInfo_.end(); ++iter) {
             std::shared_ptr<ResourceNode> resourceNode = iter->second;
-            if (resourceNode == nullptr) {
+            if (resourceNode == nullptr || socPerfConfig_.GetWorkerId(resourceNode->id) != workerId_) {
                 continue;
             }
             auto resStatus = std::make_shared<ResStatus>();
             resStatusInfo_.insert(std::pair<int32_t, std::shared_ptr<ResStatus>>(resourceNode->id, resStatus));
+            // perf so nodes are written by perf so, only the nodes socperf writes itself can be read back
+            if (!resourceNode->isGov && resourceNode->persistMode != REPORT_TO_PERFSO &&
+                std::static_pointer_cast<ResNode>(resourceNode)->readBack &&
+                !std::static_pointer_cast<ResNode>(resourceNode)->path.empty()) {
+                readBackResIds_.push_back(resourceNode->id);
+            }
         }
+        InitLimitRequest();
         InitResStatus();
     };
-    socperfQueue_.submit(initResourceNodeInfoFunc);
+    // high priority so limits submitted right after Init do not overtake it
+    ffrt::task_attr taskAttr;
+    taskAttr.priority(ffrt_queue_priority_high);
+    SubmitQueueTask(QUEUE_TASK_INIT, initResourceNodeInfoFunc, taskAttr);
 }
 
 void SocPerfThreadWrap::DoFreqActionPack(std::shared_ptr<ResActionItem> head)
@@ -61,17 +81,91 @@ void SocPerfThreadWrap::DoFreqActionPack(std::shared_ptr<ResActionItem> head)
     if (head == nullptr) {
         return;
     }
-    std::function<void()>&& doFreqActionPackFunc = [this, head]() {
+    int32_t cmdId = 0;
+    uint64_t packSeq = 0;
+    if (IsPackSupersedable(head)) {
+        cmdId = head->resAction->cmdId;
+        packSeq = MarkLatestPack(cmdId);
+    }
+    uint64_t clearSeq = perfClearSeq_.load();
+    std::function<void()>&& doFreqActionPackFunc = [this, head, cmdId, packSeq, clearSeq]() {
+        // a newer timed pack of the same cmdId queued behind this one replaces its actions anyway
+        if (packSeq != 0 && IsPackSuperseded(cmdId, packSeq)) {
+            queueStats_.OnSuperseded();
+            return;
+        }
+        // the clear request overtook this pack in the limit lane, it would have wiped these actions
+        bool cleared = clearSeq != perfClearSeq_.load();
+        int64_t nowMs = SocPerfClock::GetInstance().NowMs();
         std::shared_ptr<ResActionItem> queueHead = head;
         while (queueHead) {
-            if (socPerfConfig_.IsValidResId(queueHead->resId)) {
+            if (cleared && queueHead->resAction != nullptr && queueHead->resAction->type == ACTION_TYPE_PERF) {
+                queueHead = queueHead->next;
+                continue;
+            }
+            if (IsResActionExpired(queueHead->resAction, nowMs)) {
+                queueStats_.OnExpiredDropped();
+            } else if (IsOwnedResId(queueHead->resId)) {
+                if (queueHead->resAction->thermalActions != nullptr) {
+                    queueHead->resAction->value = GetPerfLvlValue(queueHead->resAction);
+                }
                 UpdateResActionList(queueHead->resId, queueHead->resAction, false);
             }
             queueHead = queueHead->next;
         }
         SendResStatus();
     };
-    socperfQueue_.submit(doFreqActionPackFunc);
+    SubmitRequestTask(QUEUE_TASK_REQUEST, doFreqActionPackFunc);
+}
+
+bool SocPerfThreadWrap::IsPackSupersedable(std::shared_ptr<ResActionItem> head)
+{
+    // on/off requests pair with each other and are never merged
+    return head->resAction != nullptr && head->resAction->type == ACTION_TYPE_PERF &&
+        head->resAction->onOff == EVENT_INVALID;
+}
+
+uint64_t SocPerfThreadWrap::MarkLatestPack(int32_t cmdId)
+{
+    std::lock_guard<std::mutex> lock(packSeqMutex_);
+    return ++latestPackSeq_[cmdId];
+}
+
+bool SocPerfThreadWrap::IsPackSuperseded(int32_t cmdId, uint64_t packSeq)
+{
+    std::lock_guard<std::mutex> lock(packSeqMutex_);
+    auto iter = latestPackSeq_.find(cmdId);
+    return iter != latestPackSeq_.end() && iter->second > packSeq;
+}
+
+bool SocPerfThreadWrap::IsResActionExpired(std::shared_ptr<ResAction> resAction, int64_t nowMs)
+{
+    // its release task is due already, applying it would only cost a raise and a drop
+    return resAction != nullptr && resAction->onOff != EVENT_OFF && resAction->endTime != MAX_INT_VALUE &&
+        resAction->endTime <= nowMs;
+}
+
+void SocPerfThreadWrap::SubmitRequestTask(uint8_t type, const std::function<void()>& func)
+{
+    // limits and the request switch are safety traffic, they are drained before queued boosts
+    ffrt::task_attr taskAttr;
+    taskAttr.priority(type == QUEUE_TASK_LIMIT ? ffrt_queue_priority_high : ffrt_queue_priority_low);
+    LatencyTrace trace;
+    if (!SocPerfLatency::GetActiveRequest(trace)) {
+        SubmitQueueTask(type, func, taskAttr);
+        return;
+    }
+    std::function<void()>&& tracedFunc = [this, func, trace]() mutable {
+        trace.dequeueUs = SocPerfClock::GetInstance().NowUs();
+        activeTrace_ = &trace;
+        func();
+        activeTrace_ = nullptr;
+        if (trace.arbitratedUs == 0) {
+            trace.arbitratedUs = SocPerfClock::GetInstance().NowUs();
+        }
+        SocPerfLatency::GetInstance().Record(trace);
+    };
+    SubmitQueueTask(type, tracedFunc, taskAttr);
 }
 
 void SocPerfThreadWrap::UpdatePowerLimitBoostFreq(bool powerLimitBoost)
@@ -86,7 +180,7 @@ void SocPerfThreadWrap::UpdatePowerLimitBoostFreq(bool powerLimitBoost)
         }
         SendResStatus();
     };
-    socperfQueue_.submit(updatePowerLimitBoostFreqFunc);
+    SubmitRequestTask(QUEUE_TASK_LIMIT, updatePowerLimitBoostFreqFunc);
 }
 
 void SocPerfThreadWrap::UpdateThermalLimitBoostFreq(bool thermalLimitBoost)
@@ -101,7 +195,29 @@ void SocPerfThreadWrap::UpdateThermalLimitBoostFreq(bool thermalLimitBoost)
         }
         SendResStatus();
     };
-    socperfQueue_.submit(updateThermalLimitBoostFreqFunc);
+    SubmitRequestTask(QUEUE_TASK_LIMIT, updateThermalLimitBoostFreqFunc);
+}
+
+void SocPerfThreadWrap::SetThermalLevel(int32_t level)
+{
+    std::function<void()>&& setThermalLevelFunc = [this, level]() {
+        this->thermalLvl_ = level;
+        for (const auto& item : resStatusInfo_) {
+            if (item.second == nullptr || item.second->resActionList[ACTION_TYPE_PERFLVL].empty()) {
+                continue;
+            }
+            for (const auto& resAction : item.second->resActionList[ACTION_TYPE_PERFLVL]) {
+                if (resAction->thermalActions != nullptr) {
+                    resAction->value = GetPerfLvlValue(resAction);
+                }
+            }
+            InnerArbitrateCandidatesValue(ACTION_TYPE_PERFLVL, item.second);
+            // the level also decides whether the perf level value caps or replaces the candidate
+            ArbitrateCandidate(item.first);
+        }
+        SendResStatus();
+    };
+    SubmitRequestTask(QUEUE_TASK_LIMIT, setThermalLevelFunc);
 }
 
 void SocPerfThreadWrap::UpdateLimitStatus(int32_t eventId, std::shared_ptr<ResAction> resAction, int32_t resId)
@@ -109,26 +225,138 @@ void SocPerfThreadWrap::UpdateLimitStatus(int32_t eventId, std::shared_ptr<ResAc
     if (resAction == nullptr) {
         return;
     }
-    std::function<void()>&& updateLimitStatusFunc = [this, eventId, resId, resAction]() {
-        if (eventId == INNER_EVENT_ID_DO_FREQ_ACTION) {
-            DoFreqAction(resId, resAction);
-        } else if (eventId == INNER_EVENT_ID_DO_FREQ_ACTION_LEVEL) {
-            DoFreqActionLevel(resId, resAction);
-        }
-        SendResStatus();
-        if (resAction->onOff && resStatusInfo_[resId] != nullptr) {
-            HiSysEventWrite(OHOS::HiviewDFX::HiSysEvent::Domain::RSS, "LIMIT_REQUEST",
-                            OHOS::HiviewDFX::HiSysEvent::EventType::BEHAVIOR,
-                            "CLIENT_ID", resAction->type,
-                            "RES_ID", resId,
-                            "CONFIG", resStatusInfo_[resId]->candidate);
+    // the pack tells level limits apart by their resId
+    bool levelEvent = eventId == INNER_EVENT_ID_DO_FREQ_ACTION_LEVEL;
+    if ((eventId != INNER_EVENT_ID_DO_FREQ_ACTION && !levelEvent) || levelEvent != (resId > RES_ID_ADDITION)) {
+        return;
+    }
+    auto resActionItem = std::make_shared<ResActionItem>(resId);
+    resActionItem->resAction = resAction;
+    UpdateLimitStatusPack(resActionItem);
+}
+
+void SocPerfThreadWrap::UpdateLimitStatusPack(std::shared_ptr<ResActionItem> head)
+{
+    if (head == nullptr) {
+        return;
+    }
+    std::function<void()>&& updateLimitStatusFunc = [this, head]() {
+        ApplyLimitStatusPack(head);
+    };
+    SubmitRequestTask(QUEUE_TASK_LIMIT, updateLimitStatusFunc);
+}
+
+void SocPerfThreadWrap::UpdateLimitRequest(int32_t clientId, const std::vector<int32_t>& tags,
+    const std::vector<int64_t>& configs)
+{
+    // the limit table is only touched here on the queue, callers need no lock to keep it consistent
+    std::function<void()>&& updateLimitRequestFunc = [this, clientId, tags, configs]() {
+        std::shared_ptr<ResActionItem> head = BuildLimitRequestPack(clientId, tags, configs);
+        if (head != nullptr) {
+            ApplyLimitStatusPack(head);
         }
     };
-    socperfQueue_.submit(updateLimitStatusFunc);
+    SubmitRequestTask(QUEUE_TASK_LIMIT, updateLimitRequestFunc);
+}
+
+void SocPerfThreadWrap::ApplyLimitStatusPack(std::shared_ptr<ResActionItem> head)
+{
+    for (std::shared_ptr<ResActionItem> item = head; item; item = item->next) {
+        if (item->resId > RES_ID_ADDITION) {
+            DoFreqActionLevel(item->resId, item->resAction);
+        } else {
+            DoFreqAction(item->resId, item->resAction);
+        }
+    }
+    SendResStatus();
+    for (std::shared_ptr<ResActionItem> item = head; item; item = item->next) {
+        auto iter = resStatusInfo_.find(item->resId);
+        if (item->resAction == nullptr || !item->resAction->onOff ||
+            iter == resStatusInfo_.end() || iter->second == nullptr) {
+            continue;
+        }
+        HiSysEventWrite(OHOS::HiviewDFX::HiSysEvent::Domain::RSS, "LIMIT_REQUEST",
+                        OHOS::HiviewDFX::HiSysEvent::EventType::BEHAVIOR,
+                        "CLIENT_ID", item->resAction->type,
+                        "RES_ID", item->resId,
+                        "CONFIG", iter->second->candidate);
+    }
+}
+
+void SocPerfThreadWrap::InitLimitRequest()
+{
+    limitRequest_.assign(ACTION_TYPE_MAX,
+        std::vector<int64_t>(socPerfConfig_.resSlotCnt_ * LIMIT_SLOT_PLANES, INVALID_VALUE));
+}
+
+int64_t* SocPerfThreadWrap::GetLimitRequestValue(int32_t clientId, int32_t resId)
+{
+    bool level = resId > RES_ID_ADDITION;
+    int32_t slot = socPerfConfig_.GetResSlot(level ? resId - RES_ID_ADDITION : resId);
+    // the tables are sized by InitLimitRequest
+    if (clientId < 0 || clientId >= (int32_t)limitRequest_.size() || slot == INVALID_VALUE) {
+        return nullptr;
+    }
+    std::vector<int64_t>& values = limitRequest_[clientId];
+    int32_t index = level ? slot + socPerfConfig_.resSlotCnt_ : slot;
+    if (index >= (int32_t)values.size()) {
+        return nullptr;
+    }
+    return &values[index];
+}
+
+std::shared_ptr<ResActionItem> SocPerfThreadWrap::ReleaseLimitRequest(int32_t clientId, int32_t resId,
+    std::shared_ptr<ResActionItem> curItem)
+{
+    int64_t* value = GetLimitRequestValue(clientId, resId);
+    if (value == nullptr || *value == INVALID_VALUE) {
+        return curItem;
+    }
+    bool battery = clientId == (int32_t)ACTION_TYPE_BATTERY;
+    auto resActionItem = std::make_shared<ResActionItem>(resId);
+    resActionItem->resAction = std::make_shared<ResAction>(*value, 0,
+        battery ? (int32_t)ACTION_TYPE_POWER : clientId, EVENT_OFF, battery ? BATTERY_LIMIT_CMD_ID : -1,
+        MAX_INT_VALUE);
+    curItem->next = resActionItem;
+    *value = INVALID_VALUE;
+    return resActionItem;
+}
+
+std::shared_ptr<ResActionItem> SocPerfThreadWrap::BuildLimitRequestPack(int32_t clientId,
+    const std::vector<int32_t>& tags, const std::vector<int64_t>& configs)
+{
+    bool battery = clientId == (int32_t)ACTION_TYPE_BATTERY;
+    auto header = std::make_shared<ResActionItem>(INVALID_VALUE);
+    std::shared_ptr<ResActionItem> curItem = header;
+    for (size_t i = 0; i < tags.size() && i < configs.size(); i++) {
+        int32_t realResId = tags[i] > RES_ID_ADDITION ? tags[i] - RES_ID_ADDITION : tags[i];
+        if (!IsOwnedResId(realResId)) {
+            continue;
+        }
+        // a limit given in level replaces one given in value and vice versa
+        curItem = ReleaseLimitRequest(clientId, realResId, curItem);
+        curItem = ReleaseLimitRequest(clientId, realResId + RES_ID_ADDITION, curItem);
+        if (configs[i] == INVALID_VALUE || configs[i] == RESET_VALUE) {
+            continue;
+        }
+        int64_t* value = GetLimitRequestValue(clientId, tags[i]);
+        if (value == nullptr) {
+            continue;
+        }
+        auto resActionItem = std::make_shared<ResActionItem>(tags[i]);
+        resActionItem->resAction = std::make_shared<ResAction>(configs[i], 0,
+            battery ? (int32_t)ACTION_TYPE_POWER : clientId, EVENT_ON, battery ? BATTERY_LIMIT_CMD_ID : -1,
+            MAX_INT_VALUE);
+        curItem->next = resActionItem;
+        curItem = resActionItem;
+        *value = configs[i];
+    }
+    return header->next;
 }
 
 void SocPerfThreadWrap::ClearAllAliveRequest()
 {
+    perfClearSeq_++;
     std::function<void()>&& updateLimitStatusFunc = [this]() {
         for (const auto& item : this->resStatusInfo_) {
             if (item.second == nullptr) {
@@ -138,14 +366,25 @@ void SocPerfThreadWrap::ClearAllAliveRequest()
             resActionList.clear();
             UpdateCandidatesValue(item.first, ACTION_TYPE_PERF);
         }
+        for (auto iter = holdIndex_.begin(); iter != holdIndex_.end();) {
+            iter = iter->first.second == ACTION_TYPE_PERF ? holdIndex_.erase(iter) : std::next(iter);
+        }
+        for (auto iter = holdWatchdogs_.begin(); iter != holdWatchdogs_.end();) {
+            if (HasCmdHold(iter->first)) {
+                ++iter;
+                continue;
+            }
+            CancelQueueTask(QUEUE_TASK_WATCHDOG, iter->second);
+            iter = holdWatchdogs_.erase(iter);
+        }
         SendResStatus();
     };
-    socperfQueue_.submit(updateLimitStatusFunc);
+    SubmitRequestTask(QUEUE_TASK_LIMIT, updateLimitStatusFunc);
 }
 
 void SocPerfThreadWrap::DoFreqAction(int32_t resId, std::shared_ptr<ResAction> resAction)
 {
-    if (!socPerfConfig_.IsValidResId(resId) || resAction == nullptr) {
+    if (!IsOwnedResId(resId) || resAction == nullptr) {
         return;
     }
     UpdateResActionList(resId, resAction, false);
@@ -190,7 +429,41 @@ void SocPerfThreadWrap::SetPerformanceModeStatus(bool enable)
         SOC_PERF_LOGI("SetPerformanceModeStatus is %{public}d.", enable);
         FinishTraceEx(HITRACE_LEVEL_INFO, HITRACE_TAG_SOCPERF);
     };
-    socperfQueue_.submit(performanceModeFunc);
+    SubmitQueueTask(QUEUE_TASK_STATUS, performanceModeFunc);
+}
+
+void SocPerfThreadWrap::PostScenario(const std::string& modeType, const std::string& modeStr)
+{
+    {
+        std::lock_guard<std::mutex> lock(scenarioMutex_);
+        auto iter = pendingScenario_.find(modeType);
+        if (iter != pendingScenario_.end()) {
+            // the queued task sends whatever is latest when it runs
+            iter->second = modeStr;
+            return;
+        }
+        pendingScenario_[modeType] = modeStr;
+    }
+    std::function<void()>&& scenarioFunc = [this, modeType]() {
+        std::string msgStr;
+        {
+            std::lock_guard<std::mutex> lock(scenarioMutex_);
+            auto iter = pendingScenario_.find(modeType);
+            if (iter == pendingScenario_.end()) {
+                return;
+            }
+            msgStr = modeType + ":" + iter->second;
+            pendingScenario_.erase(iter);
+        }
+        if (socPerfConfig_.scenarioFunc_ == nullptr) {
+            return;
+        }
+        SOC_PERF_LOGD("send deviceMode to PerfScenario : %{public}s", msgStr.c_str());
+        socPerfConfig_.scenarioFunc_(msgStr);
+    };
+    ffrt::task_attr taskAttr;
+    taskAttr.priority(ffrt_queue_priority_low);
+    SubmitQueueTask(QUEUE_TASK_SCENARIO, scenarioFunc, taskAttr);
 }
 
 int32_t SocPerfThreadWrap::GetModeCmdId(int32_t cmdId)
@@ -212,14 +485,62 @@ void SocPerfThreadWrap::SetWeakInteractionStatus(bool enable)
         SOC_PERF_LOGI("SetWeakInteractionStatus is %{public}d.", enable);
         FinishTraceEx(HITRACE_LEVEL_INFO, HITRACE_TAG_SOCPERF);
     };
-    socperfQueue_.submit(weakInteractionFunc);
+    SubmitQueueTask(QUEUE_TASK_STATUS, weakInteractionFunc);
+}
+
+void SocPerfThreadWrap::SetPrimaryWrap(std::shared_ptr<SocPerfThreadWrap> primaryWrap)
+{
+    primaryWrap_ = primaryWrap;
+}
+
+void SocPerfThreadWrap::SetPackDispatcher(std::function<void(std::shared_ptr<ResActionItem>)> packDispatcher)
+{
+    packDispatcher_ = packDispatcher;
+}
+
+void SocPerfThreadWrap::UpdateWorkerBoostStatus(bool boosting)
+{
+    std::function<void()>&& updateWorkerBoostFunc = [this, boosting]() {
+        workerBoostCnt_ += boosting ? 1 : -1;
+        WeakInteraction();
+    };
+    SubmitQueueTask(QUEUE_TASK_WEAK_INTERACTION, updateWorkerBoostFunc);
+}
+
+bool SocPerfThreadWrap::IsBoosting() const
+{
+    return boostResCnt != 0 || workerBoostCnt_ != 0;
+}
+
+void SocPerfThreadWrap::ReportBoostStatus()
+{
+    bool boosting = boostResCnt != 0;
+    if (boosting == reportedBoosting_) {
+        return;
+    }
+    std::shared_ptr<SocPerfThreadWrap> primaryWrap = primaryWrap_.lock();
+    if (primaryWrap == nullptr) {
+        return;
+    }
+    reportedBoosting_ = boosting;
+    primaryWrap->UpdateWorkerBoostStatus(boosting);
+}
+
+bool SocPerfThreadWrap::IsOwnedResId(int32_t resId) const
+{
+    return resStatusInfo_.find(resId) != resStatusInfo_.end();
 }
 
 void SocPerfThreadWrap::WeakInteraction()
 {
+    // interaction state lives on the primary, the other workers only report whether they are boosting
+    if (workerId_ != 0) {
+        ReportBoostStatus();
+        return;
+    }
     for (int i = 0; i < (int)socPerfConfig_.interAction_.size(); i++) {
         std::shared_ptr<InterAction> interAction = socPerfConfig_.interAction_[i];
-        if (weakInteractionStatus_ && boostResCnt == 0 && interAction->status == BOOST_STATUS) {
+        if (weakInteractionStatus_ && !IsBoosting() && interAction->status == BOOST_STATUS) {
             interAction->status = BOOST_END_STATUS;
             std::function<void()>&& updateLimitStatusFunc = [this, i]() {
                 socPerfConfig_.interAction_[i]->status = WEAK_INTERACTION_STATUS;
@@ -235,8 +556,8 @@ void SocPerfThreadWrap::WeakInteraction()
             };
             ffrt::task_attr taskAttr;
             taskAttr.delay(interAction->delayTime * SCALES_OF_MILLISECONDS_TO_MICROSECONDS);
-            interAction->timerTask = socperfQueue_.submit_h(updateLimitStatusFunc, taskAttr);
-        } else if ((!weakInteractionStatus_ || boostResCnt != 0) && interAction->status == WEAK_INTERACTION_STATUS) {
+            interAction->timerTask = SubmitQueueTaskH(QUEUE_TASK_WEAK_INTERACTION, updateLimitStatusFunc, taskAttr);
+        } else if ((!weakInteractionStatus_ || IsBoosting()) && interAction->status == WEAK_INTERACTION_STATUS) {
             interAction->status = BOOST_STATUS;
             int32_t cmdId = GetModeCmdId(interAction->cmdId);
             DoWeakInteraction(
@@ -247,12 +568,9 @@ void SocPerfThreadWrap::WeakInteraction()
             trace_str.append(",onOff[").append(std::to_string(EVENT_OFF)).append("]");
             StartTraceEx(HITRACE_LEVEL_INFO, HITRACE_TAG_SOCPERF, trace_str.c_str());
             FinishTraceEx(HITRACE_LEVEL_INFO, HITRACE_TAG_SOCPERF);
-        } else if ((!weakInteractionStatus_ || boostResCnt != 0) && interAction->status == BOOST_END_STATUS) {
+        } else if ((!weakInteractionStatus_ || IsBoosting()) && interAction->status == BOOST_END_STATUS) {
             interAction->status = BOOST_STATUS;
-            if (interAction->timerTask != nullptr) {
-                socperfQueue_.cancel(interAction->timerTask);
-                interAction->timerTask = nullptr;
-            }
+            CancelQueueTask(QUEUE_TASK_WEAK_INTERACTION, interAction->timerTask);
         }
     }
 }
@@ -282,6 +600,10 @@ void SocPerfThreadWrap::DoWeakInteraction(std::shared_ptr<Actions> actions, int3
             curItem = resActionItem;
         }
     }
+    if (packDispatcher_) {
+        packDispatcher_(header);
+        return;
+    }
     DoFreqActionPack(header);
 }
 
@@ -293,47 +615,150 @@ void SocPerfThreadWrap::SendResStatus()
     std::vector<int32_t> qosIdToRssEx;
     std::vector<int64_t> valueToRssEx;
     std::vector<int64_t> endTimeToRssEx;
+    ArbitrateConstraintDomains();
+    for (int32_t resId : GetOrderedChangedResIds()) {
+        std::shared_ptr<ResStatus> resStatus = resStatusInfo_[resId];
+        if (socPerfConfig_.resourceNodeInfo_[resId]->persistMode == REPORT_TO_PERFSO) {
+            qosId.push_back(resId);
+            value.push_back(resStatus->currentValue);
+            endTime.push_back(resStatus->currentEndTime);
+        } else {
+            qosIdToRssEx.push_back(resId);
+            valueToRssEx.push_back(resStatus->currentValue);
+            endTimeToRssEx.push_back(resStatus->currentEndTime);
+        }
+        if (socPerfConfig_.resourceNodeInfo_[resId]->trace) {
+            CountTraceEx(HITRACE_LEVEL_INFO, HITRACE_TAG_SOCPERF,
+                socPerfConfig_.resourceNodeInfo_[resId]->name.c_str(),
+                resStatus->currentValue == MAX_INT32_VALUE ? NODE_DEFAULT_VALUE : resStatus->currentValue);
+        }
+    }
+    if (activeTrace_ != nullptr && activeTrace_->arbitratedUs == 0) {
+        activeTrace_->arbitratedUs = SocPerfClock::GetInstance().NowUs();
+    }
+    if (ReportToPerfSo(qosId, value, endTime)) {
+        AckResStatus(qosId, value, endTime);
+        reportRetryCnt_ = 0;
+    } else {
+        PostReportRetryTask();
+    }
+    // rssexe writes nodes asynchronously without reply, submitting the request is treated as applied
+    ReportToRssExe(qosIdToRssEx, valueToRssEx, endTimeToRssEx);
+    AckResStatus(qosIdToRssEx, valueToRssEx, endTimeToRssEx);
+    StartReadBackTimer();
+    if (activeTrace_ != nullptr && (!qosId.empty() || !qosIdToRssEx.empty())) {
+        activeTrace_->reportedUs = SocPerfClock::GetInstance().NowUs();
+    }
+
+    WeakInteraction();
+}
+
+bool SocPerfThreadWrap::IsResStatusChanged(int32_t resId)
+{
+    auto iter = resStatusInfo_.find(resId);
+    if (iter == resStatusInfo_.end() || iter->second == nullptr) {
+        return false;
+    }
+    auto nodeIter = socPerfConfig_.resourceNodeInfo_.find(resId);
+    if (nodeIter == socPerfConfig_.resourceNodeInfo_.end() || nodeIter->second == nullptr) {
+        return false;
+    }
+    return iter->second->previousValue != iter->second->currentValue ||
+        iter->second->previousEndTime != iter->second->currentEndTime;
+}
+
+std::vector<int32_t> SocPerfThreadWrap::GetOrderedChangedResIds()
+{
+    std::vector<int32_t> changedResIds;
+    std::unordered_set<int32_t> orderedDomains;
     for (auto iter = resStatusInfo_.begin(); iter != resStatusInfo_.end(); ++iter) {
         int32_t resId = iter->first;
-        std::shared_ptr<ResStatus> resStatus = iter->second;
-        if (socPerfConfig_.resourceNodeInfo_.find(resId) != socPerfConfig_.resourceNodeInfo_.end() &&
-            (resStatus->previousValue != resStatus->currentValue ||
-            resStatus->previousEndTime != resStatus->currentEndTime)) {
-            if (socPerfConfig_.resourceNodeInfo_[resId] == nullptr) {
-                continue;
-            }
-            if (socPerfConfig_.resourceNodeInfo_[resId]->persistMode == REPORT_TO_PERFSO) {
-                qosId.push_back(resId);
-                value.push_back(resStatus->currentValue);
-                endTime.push_back(resStatus->currentEndTime);
-            } else {
-                qosIdToRssEx.push_back(resId);
-                valueToRssEx.push_back(resStatus->currentValue);
-                endTimeToRssEx.push_back(resStatus->currentEndTime);
+        if (!IsResStatusChanged(resId)) {
+            continue;
+        }
+        auto domainIter = socPerfConfig_.resConstraintDomain_.find(resId);
+        if (domainIter == socPerfConfig_.resConstraintDomain_.end()) {
+            changedResIds.push_back(resId);
+            continue;
+        }
+        if (!orderedDomains.insert(domainIter->second).second) {
+            continue;
+        }
+        // cpufreq rejects min above max, so raised resources go from the top of the order and lowered ones
+        // from the bottom, every intermediate state keeps the order constraints
+        std::shared_ptr<ConstraintDomain> domain = socPerfConfig_.constraintDomains_[domainIter->second];
+        for (auto it = domain->resIds.rbegin(); it != domain->resIds.rend(); ++it) {
+            if (IsResStatusChanged(*it) && IsResValueRaised(*it)) {
+                changedResIds.push_back(*it);
             }
-            resStatus->previousValue = resStatus->currentValue;
-            resStatus->previousEndTime = resStatus->currentEndTime;
-            if (socPerfConfig_.resourceNodeInfo_[resId]->trace) {
-                CountTraceEx(HITRACE_LEVEL_INFO, HITRACE_TAG_SOCPERF,
-                    socPerfConfig_.resourceNodeInfo_[resId]->name.c_str(),
-                    resStatus->currentValue == MAX_INT32_VALUE ? NODE_DEFAULT_VALUE : resStatus->currentValue);
+        }
+        for (auto it = domain->resIds.begin(); it != domain->resIds.end(); ++it) {
+            if (IsResStatusChanged(*it) && !IsResValueRaised(*it)) {
+                changedResIds.push_back(*it);
             }
         }
     }
-    ReportToPerfSo(qosId, value, endTime);
-    ReportToRssExe(qosIdToRssEx, valueToRssEx, endTimeToRssEx);
+    return changedResIds;
+}
 
-    WeakInteraction();
+bool SocPerfThreadWrap::IsResValueRaised(int32_t resId)
+{
+    std::shared_ptr<ResStatus> resStatus = resStatusInfo_[resId];
+    // default value of a max node means no limit, of other nodes means no floor
+    int64_t defValue = socPerfConfig_.resourceNodeInfo_[resId]->isMaxValue ? MAX_INT_VALUE : MIN_INT_VALUE;
+    int64_t prevValue = resStatus->previousValue == NODE_DEFAULT_VALUE ? defValue : resStatus->previousValue;
+    int64_t currValue = resStatus->currentValue == NODE_DEFAULT_VALUE ? defValue : resStatus->currentValue;
+    return currValue > prevValue;
 }
 
-void SocPerfThreadWrap::ReportToPerfSo(std::vector<int32_t>& qosId, std::vector<int64_t>& value,
+void SocPerfThreadWrap::AckResStatus(const std::vector<int32_t>& qosId, const std::vector<int64_t>& value,
+    const std::vector<int64_t>& endTime)
+{
+    for (uint32_t i = 0; i < qosId.size(); i++) {
+        auto iter = resStatusInfo_.find(qosId[i]);
+        if (iter == resStatusInfo_.end() || iter->second == nullptr) {
+            continue;
+        }
+        iter->second->previousValue = value[i];
+        iter->second->previousEndTime = endTime[i];
+    }
+}
+
+void SocPerfThreadWrap::PostReportRetryTask()
+{
+    if (reportRetryPending_) {
+        return;
+    }
+    // a few quick attempts ride out a short perf so hiccup, a longer outage falls back to a slow retry
+    // that keeps going until the unacked resources are applied
+    int32_t delayMs = reportRetryCnt_ < MAX_REPORT_RETRY_TIMES ? REPORT_RETRY_DELAY_MS : REPORT_RETRY_SLOW_DELAY_MS;
+    reportRetryPending_ = true;
+    if (reportRetryCnt_ < MAX_REPORT_RETRY_TIMES) {
+        reportRetryCnt_++;
+    }
+    std::function<void()>&& reportRetryFunc = [this]() {
+        reportRetryPending_ = false;
+        SendResStatus();
+    };
+    ffrt::task_attr taskAttr;
+    taskAttr.delay(delayMs * SCALES_OF_MILLISECONDS_TO_MICROSECONDS);
+    SubmitQueueTask(QUEUE_TASK_REPORT_RETRY, reportRetryFunc, taskAttr);
+}
+
+bool SocPerfThreadWrap::ReportToPerfSo(std::vector<int32_t>& qosId, std::vector<int64_t>& value,
     std::vector<int64_t>& endTime)
 {
     if (!socPerfConfig_.reportFunc_) {
-        return;
+        return true;
     }
     if (qosId.size() > 0) {
-        socPerfConfig_.reportFunc_(qosId, value, endTime, "");
+        std::vector<int64_t> wallEndTime(endTime);
+        for (int64_t& time : wallEndTime) {
+            if (time != MAX_INT_VALUE) {
+                time = SocPerfClock::GetInstance().ToWallTimeMs(time);
+            }
+        }
+        int32_t ret = socPerfConfig_.reportFunc_(qosId, value, wallEndTime, "");
         std::string log("send data to perf so");
         for (unsigned long i = 0; i < qosId.size(); i++) {
             log.append(",[id:").append(std::to_string(qosId[i]));
@@ -341,7 +766,12 @@ void SocPerfThreadWrap::ReportToPerfSo(std::vector<int32_t>& qosId, std::vector<
         }
         StartTraceEx(HITRACE_LEVEL_INFO, HITRACE_TAG_SOCPERF, log.c_str());
         FinishTraceEx(HITRACE_LEVEL_INFO, HITRACE_TAG_SOCPERF);
+        if (ret < 0) {
+            SOC_PERF_LOGW("perf so rejected %{public}zu resources, ret %{public}d", qosId.size(), ret);
+            return false;
+        }
     }
+    return true;
 }
 
 void SocPerfThreadWrap::ReportToRssExe(std::vector<int32_t>& qosId, std::vector<int64_t>& value,
@@ -363,10 +793,98 @@ void SocPerfThreadWrap::ReportToRssExe(std::vector<int32_t>& qosId, std::vector<
     }
 }
 
+void SocPerfThreadWrap::StartReadBackTimer()
+{
+    // the timer only runs while socperf holds a read back node, an idle device is not woken up every second
+    if (readBackTimerPending_ || !HasReadBackHold()) {
+        return;
+    }
+    readBackTimerPending_ = true;
+    std::function<void()>&& readBackFunc = [this]() {
+        readBackTimerPending_ = false;
+        DoReconcileResStatus();
+        StartReadBackTimer();
+    };
+    ffrt::task_attr taskAttr;
+    taskAttr.delay(READ_BACK_INTERVAL_MS * SCALES_OF_MILLISECONDS_TO_MICROSECONDS);
+    SubmitQueueTask(QUEUE_TASK_RECONCILE, readBackFunc, taskAttr);
+}
+
+bool SocPerfThreadWrap::HasReadBackHold()
+{
+    for (int32_t resId : readBackResIds_) {
+        // a released node belongs to the kernel default
+        if (resStatusInfo_[resId]->previousValue != NODE_DEFAULT_VALUE) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void SocPerfThreadWrap::DoReconcileResStatus()
+{
+    bool drift = false;
+    for (int32_t resId : readBackResIds_) {
+        std::shared_ptr<ResStatus> resStatus = resStatusInfo_[resId];
+        if (resStatus->previousValue == NODE_DEFAULT_VALUE) {
+            continue;
+        }
+        std::shared_ptr<ResNode> resNode =
+            std::static_pointer_cast<ResNode>(socPerfConfig_.resourceNodeInfo_[resId]);
+        int64_t nodeValue = 0;
+        if (!ReadResNodeValue(resNode->path, nodeValue) ||
+            IsNodeValueApplied(resNode, resStatus->previousValue, nodeValue)) {
+            continue;
+        }
+        SOC_PERF_LOGI("resId[%{public}d] drift, applied %{public}lld, node %{public}lld", resId,
+            (long long)resStatus->previousValue, (long long)nodeValue);
+        resStatus->previousValue = nodeValue;
+        drift = true;
+    }
+    if (drift) {
+        SendResStatus();
+    }
+}
+
+bool SocPerfThreadWrap::IsNodeValueApplied(std::shared_ptr<ResNode> resNode, int64_t appliedValue,
+    int64_t nodeValue)
+{
+    if (nodeValue == appliedValue) {
+        return true;
+    }
+    // the kernel rounds a written value onto its own steps, a cpufreq node reads back the opp it picked,
+    // so a value on the same available step as the applied one is not a drift
+    return !resNode->available.empty() &&
+        resNode->GetNearestAvailable(nodeValue) == resNode->GetNearestAvailable(appliedValue);
+}
+
+bool SocPerfThreadWrap::ReadResNodeValue(const std::string& path, int64_t& value)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    char buf[MAX_NODE_VALUE_LEN] = {0};
+    ssize_t len = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (len <= 0) {
+        return false;
+    }
+    std::string valueStr(buf, len);
+    while (!valueStr.empty() && (valueStr.back() == '\n' || valueStr.back() == ' ')) {
+        valueStr.pop_back();
+    }
+    if (valueStr.empty() || !IsNumber(valueStr)) {
+        return false;
+    }
+    value = atoll(valueStr.c_str());
+    return true;
+}
+
 void SocPerfThreadWrap::DoFreqActionLevel(int32_t resId, std::shared_ptr<ResAction> resAction)
 {
     int32_t realResId = resId - RES_ID_ADDITION;
-    if (!socPerfConfig_.IsValidResId(realResId) || !resAction) {
+    if (!IsOwnedResId(realResId) || !resAction) {
         return;
     }
     int32_t level = (int32_t)resAction->value;
@@ -400,32 +918,111 @@ void SocPerfThreadWrap::PostDelayTask(std::shared_ptr<ResActionItem> queueHead)
             }
             SendResStatus();
         };
-        socperfQueue_.submit(postDelayTaskFunc, taskAttr);
+        SubmitQueueTask(QUEUE_TASK_EXPIRY, postDelayTaskFunc, taskAttr);
+    }
+}
+
+void SocPerfThreadWrap::PostHoldWatchdog(std::shared_ptr<ResActionItem> queueHead)
+{
+    std::vector<std::shared_ptr<ResActionItem>> items;
+    for (std::shared_ptr<ResActionItem> head = queueHead; head; head = head->next) {
+        if (head->resAction != nullptr && head->resAction->maxHoldMs > 0) {
+            items.push_back(head);
+        }
+    }
+    if (items.empty()) {
+        return;
+    }
+    // armed on the queue behind the request, the handle is only touched there
+    std::function<void()>&& armWatchdogFunc = [this, items]() {
+        int32_t cmdId = items[0]->resAction->cmdId;
+        // a newer on of the cmd restarts the watchdog of the hold it replaced
+        auto iter = holdWatchdogs_.find(cmdId);
+        if (iter != holdWatchdogs_.end()) {
+            CancelQueueTask(QUEUE_TASK_WATCHDOG, iter->second);
+            holdWatchdogs_.erase(iter);
+        }
+        if (!HasCmdHold(cmdId)) {
+            return;
+        }
+        // all holds of one request share the maxHold of its cmd
+        ffrt::task_attr taskAttr;
+        taskAttr.delay((uint64_t)items[0]->resAction->maxHoldMs * SCALES_OF_MILLISECONDS_TO_MICROSECONDS);
+        std::function<void()>&& holdWatchdogFunc = [this, items, cmdId]() {
+            holdWatchdogs_.erase(cmdId);
+            ExpireHolds(items);
+        };
+        holdWatchdogs_[cmdId] = SubmitQueueTaskH(QUEUE_TASK_WATCHDOG, holdWatchdogFunc, taskAttr);
+    };
+    SubmitQueueTask(QUEUE_TASK_WATCHDOG, armWatchdogFunc);
+}
+
+bool SocPerfThreadWrap::HasCmdHold(int32_t cmdId) const
+{
+    return holdIndex_.find(std::make_pair(cmdId, (int32_t)ACTION_TYPE_PERF)) != holdIndex_.end() ||
+        holdIndex_.find(std::make_pair(cmdId, (int32_t)ACTION_TYPE_PERFLVL)) != holdIndex_.end();
+}
+
+void SocPerfThreadWrap::CancelHoldWatchdog(int32_t cmdId)
+{
+    // the watchdog covers every hold of the request, it goes with the last of them
+    auto iter = holdWatchdogs_.find(cmdId);
+    if (iter == holdWatchdogs_.end() || HasCmdHold(cmdId)) {
+        return;
+    }
+    CancelQueueTask(QUEUE_TASK_WATCHDOG, iter->second);
+    holdWatchdogs_.erase(iter);
+}
+
+void SocPerfThreadWrap::ExpireHolds(const std::vector<std::shared_ptr<ResActionItem>>& items)
+{
+    std::shared_ptr<ResAction> expired = nullptr;
+    for (const auto& item : items) {
+        auto iter = resStatusInfo_.find(item->resId);
+        if (iter == resStatusInfo_.end() || iter->second == nullptr) {
+            continue;
+        }
+        // an off, a newer on of the same cmd or a clear already took it out
+        std::list<std::shared_ptr<ResAction>>& resActionList = iter->second->resActionList[item->resAction->type];
+        if (std::find(resActionList.begin(), resActionList.end(), item->resAction) == resActionList.end()) {
+            continue;
+        }
+        UpdateResActionList(item->resId, item->resAction, true);
+        if (expired == nullptr || item->resAction->reportExpiry) {
+            expired = item->resAction;
+        }
+    }
+    if (expired == nullptr) {
+        return;
+    }
+    SendResStatus();
+    if (!expired->reportExpiry) {
+        return;
     }
+    holdLeaks_[expired->cmdId]++;
+    SOC_PERF_LOGW("cmdId %{public}d of pid %{public}d held over %{public}dms without off, released",
+        expired->cmdId, expired->callerPid, expired->maxHoldMs);
+    std::string abnormalInfo = "cmdId:" + std::to_string(expired->cmdId) + ", pid:" +
+        std::to_string(expired->callerPid) + ", maxHold:" + std::to_string(expired->maxHoldMs) + "ms";
+    HiSysEventWrite(OHOS::HiviewDFX::HiSysEvent::Domain::RSS, "SCHEDULE_ABNORMAL_INFO",
+                    OHOS::HiviewDFX::HiSysEvent::EventType::STATISTIC,
+                    "ABNORMAL_MODULE", "SOCPERF",
+                    "ABNORMAL_TYPE", ABNORMAL_TYPE_SOCPERF_HOLD_EXPIRED,
+                    "ABNORMAL_CODE", expired->cmdId,
+                    "ABNORMAL_INFO", abnormalInfo);
 }
 
 bool SocPerfThreadWrap::GetResValueByLevel(int32_t resId, int32_t level, int64_t& resValue)
 {
-    if (socPerfConfig_.resourceNodeInfo_.find(resId) == socPerfConfig_.resourceNodeInfo_.end()
-        || socPerfConfig_.resourceNodeInfo_[resId] == nullptr
-        || socPerfConfig_.resourceNodeInfo_[resId]->available.empty()) {
+    auto iter = socPerfConfig_.resourceNodeInfo_.find(resId);
+    if (iter == socPerfConfig_.resourceNodeInfo_.end() || iter->second == nullptr || iter->second->available.empty()) {
         SOC_PERF_LOGE("resId[%{public}d] is not valid.", resId);
         return false;
     }
     if (level < 0) {
         return false;
     }
-
-    std::set<int64_t> available;
-    for (auto a : socPerfConfig_.resourceNodeInfo_[resId]->available) {
-        available.insert(a);
-    }
-    int32_t len = (int32_t)available.size();
-    auto iter = available.begin();
-    if (level < len) {
-        std::advance(iter, len - 1 - level);
-    }
-    resValue = *iter;
+    resValue = iter->second->GetValueByLevel(level);
     return true;
 }
 
@@ -447,6 +1044,9 @@ void SocPerfThreadWrap::UpdateResActionListByDelayedMsg(int32_t resId, int32_t t
     for (auto iter = resStatus->resActionList[type].begin();
         iter != resStatus->resActionList[type].end(); ++iter) {
         if (resAction == *iter) {
+            if (resAction->onOff == EVENT_ON) {
+                RemoveHold(resId, iter);
+            }
             resStatus->resActionList[type].erase(iter);
             UpdateCandidatesValue(resId, type);
             if (resAction->interaction) {
@@ -463,6 +1063,9 @@ void SocPerfThreadWrap::HandleResAction(int32_t resId, int32_t type,
     for (auto iter = resStatus->resActionList[type].begin();
          iter != resStatus->resActionList[type].end(); ++iter) {
         if (resAction->TotalSame(*iter)) {
+            if (resAction->onOff == EVENT_ON) {
+                RemoveHold(resId, iter);
+            }
             resStatus->resActionList[type].erase(iter);
             if (resAction->interaction) {
                 boostResCnt--;
@@ -471,6 +1074,9 @@ void SocPerfThreadWrap::HandleResAction(int32_t resId, int32_t type,
         }
     }
     resStatus->resActionList[type].push_back(resAction);
+    if (resAction->onOff == EVENT_ON) {
+        AddHold(resId, std::prev(resStatus->resActionList[type].end()));
+    }
     UpdateCandidatesValue(resId, type);
     if (resAction->interaction) {
         boostResCnt++;
@@ -487,14 +1093,9 @@ void SocPerfThreadWrap::UpdateResActionListByInstantMsg(int32_t resId, int32_t t
             break;
         }
         case EVENT_OFF: {
-            for (auto iter = resStatus->resActionList[type].begin();
-                iter != resStatus->resActionList[type].end(); ++iter) {
-                if (resAction->PartSame(*iter) && (*iter)->onOff == EVENT_ON) {
-                    resStatus->resActionList[type].erase(iter);
-                    UpdateCandidatesValue(resId, type);
-                    boostResCnt = boostResCnt - (resAction->interaction ? 1 : 0);
-                    break;
-                }
+            if (ReleaseHold(resId, resAction, resStatus)) {
+                UpdateCandidatesValue(resId, type);
+                boostResCnt = boostResCnt - (resAction->interaction ? 1 : 0);
             }
             break;
         }
@@ -504,6 +1105,71 @@ void SocPerfThreadWrap::UpdateResActionListByInstantMsg(int32_t resId, int32_t t
     }
 }
 
+void SocPerfThreadWrap::AddHold(int32_t resId, std::list<std::shared_ptr<ResAction>>::iterator actionIter)
+{
+    holdIndex_[std::make_pair((*actionIter)->cmdId, (*actionIter)->type)][resId].push_back(actionIter);
+}
+
+void SocPerfThreadWrap::RemoveHold(int32_t resId, std::list<std::shared_ptr<ResAction>>::iterator actionIter)
+{
+    auto indexIter = holdIndex_.find(std::make_pair((*actionIter)->cmdId, (*actionIter)->type));
+    if (indexIter == holdIndex_.end()) {
+        return;
+    }
+    auto resIter = indexIter->second.find(resId);
+    if (resIter == indexIter->second.end()) {
+        return;
+    }
+    auto& actionIters = resIter->second;
+    actionIters.erase(std::remove(actionIters.begin(), actionIters.end(), actionIter), actionIters.end());
+    if (actionIters.empty()) {
+        indexIter->second.erase(resIter);
+    }
+    if (indexIter->second.empty()) {
+        holdIndex_.erase(indexIter);
+        CancelHoldWatchdog((*actionIter)->cmdId);
+    }
+}
+
+bool SocPerfThreadWrap::ReleaseHold(int32_t resId, std::shared_ptr<ResAction> resAction,
+    std::shared_ptr<ResStatus> resStatus)
+{
+    auto indexIter = holdIndex_.find(std::make_pair(resAction->cmdId, resAction->type));
+    if (indexIter == holdIndex_.end()) {
+        return false;
+    }
+    auto resIter = indexIter->second.find(resId);
+    if (resIter == indexIter->second.end()) {
+        return false;
+    }
+    // the oldest matching hold goes first, as the list scan it replaces did
+    auto& actionIters = resIter->second;
+    for (auto iter = actionIters.begin(); iter != actionIters.end(); ++iter) {
+        if (!resAction->PartSame(**iter)) {
+            continue;
+        }
+        resStatus->resActionList[resAction->type].erase(*iter);
+        actionIters.erase(iter);
+        if (actionIters.empty()) {
+            indexIter->second.erase(resIter);
+        }
+        if (indexIter->second.empty()) {
+            holdIndex_.erase(indexIter);
+            CancelHoldWatchdog(resAction->cmdId);
+        }
+        return true;
+    }
+    return false;
+}
+
+int64_t SocPerfThreadWrap::GetPerfLvlValue(std::shared_ptr<ResAction> resAction)
+{
+    if (thermalLvl_ < socPerfConfig_.minThermalLvl_) {
+        return INVALID_VALUE;
+    }
+    return resAction->thermalActions->GetThermalLvlValue(thermalLvl_, resAction->thermalResIndex);
+}
+
 void SocPerfThreadWrap::UpdateCandidatesValue(int32_t resId, int32_t type)
 {
     std::shared_ptr<ResStatus> resStatus = resStatusInfo_[resId];
@@ -548,17 +1214,23 @@ void SocPerfThreadWrap::ArbitrateCandidate(int32_t resId)
 {
     std::shared_ptr<ResStatus> resStatus = resStatusInfo_[resId];
     // if perf, power and thermal don't have valid value, send default value
-    if (ExistNoCandidate(resId, resStatus)) {
-        return;
+    if (!ExistNoCandidate(resId, resStatus)) {
+        // Arbitrate in perf, power and thermal
+        ProcessLimitCase(resId);
+        // perf request thermal level is highest priority in this freq adjuster
+        ArbitratePerfLvl(resStatus);
+        // requests in abstract units land on the operating point the node accepts
+        if (resStatus->candidate != NODE_DEFAULT_VALUE) {
+            resStatus->candidate = socPerfConfig_.resourceNodeInfo_[resId]->SnapAvailable(resStatus->candidate);
+        }
     }
-    // Arbitrate in perf, power and thermal
-    ProcessLimitCase(resId);
-    // perf request thermal level is highest priority in this freq adjuster
-    if (ArbitratePairResInPerfLvl(resId)) {
+    // resources under constraint groups are adjusted together right before sending
+    auto iter = socPerfConfig_.resConstraintDomain_.find(resId);
+    if (iter == socPerfConfig_.resConstraintDomain_.end()) {
+        UpdateCurrentValue(resId, resStatus->candidate);
         return;
     }
-    // adjust resource value if it has 'max' config
-    ArbitratePairRes(resId, false);
+    dirtyConstraintDomains_.insert(iter->second);
 }
 
 void SocPerfThreadWrap::ProcessLimitCase(int32_t resId)
@@ -594,99 +1266,112 @@ void SocPerfThreadWrap::ProcessLimitCase(int32_t resId)
         resStatus->candidatesEndTime[ACTION_TYPE_POWER], resStatus->candidatesEndTime[ACTION_TYPE_THERMAL]);
 }
 
-bool SocPerfThreadWrap::ArbitratePairResInPerfLvl(int32_t resId)
+void SocPerfThreadWrap::ArbitratePerfLvl(std::shared_ptr<ResStatus> resStatus)
 {
-    std::shared_ptr<ResStatus> resStatus = resStatusInfo_[resId];
-    int32_t pairResId = INVALID_VALUE;
-    if (!socPerfConfig_.IsGovResId(resId)) {
-        pairResId = std::static_pointer_cast<ResNode>(socPerfConfig_.resourceNodeInfo_[resId])->pair;
-    }
-    // if resource self and resource's pair both not have perflvl value
-    if (resStatus->candidatesValue[ACTION_TYPE_PERFLVL] == INVALID_VALUE && (pairResId != INVALID_VALUE &&
-        (resStatusInfo_[pairResId] == nullptr ||
-        resStatusInfo_[pairResId]->candidatesValue[ACTION_TYPE_PERFLVL] == INVALID_VALUE))) {
-        return false;
-    }
     // if this resource has PerfRequestLvl value, the final arbitrate value change to PerfRequestLvl value
-    if (resStatus->candidatesValue[ACTION_TYPE_PERFLVL] != INVALID_VALUE) {
-        if (thermalLvl_ == 0 && resStatus->candidate != INVALID_VALUE) {
-            resStatus->candidate = Min(resStatus->candidate, resStatus->candidatesValue[ACTION_TYPE_PERFLVL]);
-        } else {
-            resStatus->candidate = resStatus->candidatesValue[ACTION_TYPE_PERFLVL];
-        }
+    if (resStatus->candidatesValue[ACTION_TYPE_PERFLVL] == INVALID_VALUE) {
+        return;
+    }
+    if (thermalLvl_ == 0 && resStatus->candidate != INVALID_VALUE) {
+        resStatus->candidate = Min(resStatus->candidate, resStatus->candidatesValue[ACTION_TYPE_PERFLVL]);
+    } else {
+        resStatus->candidate = resStatus->candidatesValue[ACTION_TYPE_PERFLVL];
     }
-    // only limit max when PerfRequestLvl has max value
-    bool limit = false;
-    if (thermalLvl_ != 0 &&
-        !socPerfConfig_.IsGovResId(resId) &&
-        ((socPerfConfig_.resourceNodeInfo_[resId] != nullptr && socPerfConfig_.resourceNodeInfo_[resId]->isMaxValue) ||
-        (pairResId != INVALID_VALUE && socPerfConfig_.resourceNodeInfo_[pairResId] != nullptr &&
-        socPerfConfig_.resourceNodeInfo_[pairResId]->isMaxValue))) {
-        limit = true;
-    }
-    ArbitratePairRes(resId, limit);
-    return true;
 }
 
-void SocPerfThreadWrap::ArbitratePairRes(int32_t resId, bool perfRequestLimit)
+void SocPerfThreadWrap::ArbitrateConstraintDomains()
 {
-    bool limit = powerLimitBoost_ || thermalLimitBoost_ || perfRequestLimit;
-    if (resStatusInfo_[resId] == nullptr) {
-        return;
+    for (int32_t domainId : dirtyConstraintDomains_) {
+        ArbitrateConstraintDomain(domainId);
     }
-    if (socPerfConfig_.IsGovResId(resId)) {
-        UpdateCurrentValue(resId, resStatusInfo_[resId]->candidate);
+    dirtyConstraintDomains_.clear();
+}
+
+void SocPerfThreadWrap::ArbitrateConstraintDomain(int32_t domainId)
+{
+    if (domainId < 0 || domainId >= (int32_t)socPerfConfig_.constraintDomains_.size()) {
         return;
     }
-    int32_t pairResId = std::static_pointer_cast<ResNode>(socPerfConfig_.resourceNodeInfo_[resId])->pair;
-    if (pairResId == INVALID_VALUE) {
+    std::shared_ptr<ConstraintDomain> domain = socPerfConfig_.constraintDomains_[domainId];
+    for (int32_t resId : domain->resIds) {
+        if (resStatusInfo_[resId] == nullptr) {
+            return;
+        }
         UpdateCurrentValue(resId, resStatusInfo_[resId]->candidate);
+    }
+    for (const auto& group : domain->followGroups) {
+        ArbitrateFollowGroup(group);
+    }
+    // only limit max when PerfRequestLvl has max value
+    bool perfRequestLimit = thermalLvl_ != 0 && domain->hasMaxRes && ExistPerfLvlInDomain(domain);
+    if (powerLimitBoost_ || thermalLimitBoost_ || perfRequestLimit) {
+        // limits win, a lowered upper resource pulls the lower ones down
+        for (const auto& edge : domain->limitEdges) {
+            std::shared_ptr<ResStatus> lower = resStatusInfo_[edge.first];
+            std::shared_ptr<ResStatus> upper = resStatusInfo_[edge.second];
+            if (lower->currentValue != NODE_DEFAULT_VALUE && upper->currentValue != NODE_DEFAULT_VALUE) {
+                lower->currentValue = Min(lower->currentValue, upper->currentValue);
+            }
+        }
         return;
     }
+    // boosts win, a raised lower resource pushes the upper ones up
+    for (const auto& edge : domain->raiseEdges) {
+        std::shared_ptr<ResStatus> lower = resStatusInfo_[edge.first];
+        std::shared_ptr<ResStatus> upper = resStatusInfo_[edge.second];
+        if (lower->currentValue != NODE_DEFAULT_VALUE && upper->currentValue != NODE_DEFAULT_VALUE) {
+            upper->currentValue = Max(lower->currentValue, upper->currentValue);
+        }
+    }
+}
 
-    if (resStatusInfo_[pairResId] == nullptr) {
-        return;
+bool SocPerfThreadWrap::ExistPerfLvlInDomain(std::shared_ptr<ConstraintDomain> domain)
+{
+    for (int32_t resId : domain->resIds) {
+        if (resStatusInfo_[resId] != nullptr &&
+            resStatusInfo_[resId]->candidatesValue[ACTION_TYPE_PERFLVL] != INVALID_VALUE) {
+            return true;
+        }
     }
-    if (resStatusInfo_[pairResId]->candidate == NODE_DEFAULT_VALUE ||
-        resStatusInfo_[resId]->candidate == NODE_DEFAULT_VALUE) {
-        UpdatePairResValue(resId, resStatusInfo_[resId]->candidate, pairResId, resStatusInfo_[pairResId]->candidate);
+    return false;
+}
+
+void SocPerfThreadWrap::ArbitrateFollowGroup(std::shared_ptr<ConstraintGroup> group)
+{
+    std::shared_ptr<ResStatus> srcStatus = resStatusInfo_[group->resIds[0]];
+    if (srcStatus == nullptr || srcStatus->currentValue == NODE_DEFAULT_VALUE) {
         return;
     }
-
-    if (socPerfConfig_.resourceNodeInfo_[resId]->isMaxValue) {
-        if (resStatusInfo_[resId]->candidate < resStatusInfo_[pairResId]->candidate) {
-            if (limit) {
-                UpdatePairResValue(pairResId,
-                    resStatusInfo_[resId]->candidate, resId, resStatusInfo_[resId]->candidate);
-            } else {
-                UpdatePairResValue(pairResId,
-                    resStatusInfo_[pairResId]->candidate, resId, resStatusInfo_[pairResId]->candidate);
-            }
-        } else {
-            UpdatePairResValue(pairResId,
-                resStatusInfo_[pairResId]->candidate, resId, resStatusInfo_[resId]->candidate);
+    int64_t floor = INVALID_VALUE;
+    for (const auto& item : group->floorMap) {
+        if (item.first > srcStatus->currentValue) {
+            break;
         }
-    } else {
-        if (resStatusInfo_[resId]->candidate > resStatusInfo_[pairResId]->candidate) {
-            if (limit) {
-                UpdatePairResValue(resId,
-                    resStatusInfo_[pairResId]->candidate, pairResId, resStatusInfo_[pairResId]->candidate);
-            } else {
-                UpdatePairResValue(resId,
-                    resStatusInfo_[resId]->candidate, pairResId, resStatusInfo_[resId]->candidate);
-            }
-        } else {
-            UpdatePairResValue(resId,
-                resStatusInfo_[resId]->candidate, pairResId, resStatusInfo_[pairResId]->candidate);
+        floor = item.second;
+    }
+    if (floor == INVALID_VALUE) {
+        return;
+    }
+    for (size_t i = 1; i < group->resIds.size(); i++) {
+        std::shared_ptr<ResStatus> resStatus = resStatusInfo_[group->resIds[i]];
+        if (resStatus == nullptr) {
+            continue;
         }
+        int64_t value = resStatus->currentValue == NODE_DEFAULT_VALUE ? floor : Max(resStatus->currentValue, floor);
+        resStatus->currentValue = Min(value, GetLimitCeiling(resStatus));
     }
 }
 
-void SocPerfThreadWrap::UpdatePairResValue(int32_t minResId, int64_t minResValue, int32_t maxResId,
-    int64_t maxResValue)
+int64_t SocPerfThreadWrap::GetLimitCeiling(std::shared_ptr<ResStatus> resStatus)
 {
-    UpdateCurrentValue(minResId, minResValue);
-    UpdateCurrentValue(maxResId, maxResValue);
+    int64_t ceiling = MAX_INT_VALUE;
+    if (powerLimitBoost_ && resStatus->candidatesValue[ACTION_TYPE_POWER] != INVALID_VALUE) {
+        ceiling = Min(ceiling, resStatus->candidatesValue[ACTION_TYPE_POWER]);
+    }
+    if (thermalLimitBoost_ && resStatus->candidatesValue[ACTION_TYPE_THERMAL] != INVALID_VALUE) {
+        ceiling = Min(ceiling, resStatus->candidatesValue[ACTION_TYPE_THERMAL]);
+    }
+    return ceiling;
 }
 
 void SocPerfThreadWrap::UpdateCurrentValue(int32_t resId, int64_t currValue)
@@ -707,24 +1392,124 @@ bool SocPerfThreadWrap::ExistNoCandidate(int32_t resId, std::shared_ptr<ResStatu
         && perfLvlCandidate == INVALID_VALUE) {
         resStatus->candidate = NODE_DEFAULT_VALUE;
         resStatus->currentEndTime = MAX_INT_VALUE;
-        ArbitratePairRes(resId, false);
         return true;
     }
     return false;
 }
 
+void SocPerfThreadWrap::GetStateSnapshot(SocPerfStateSnapshot& snapshot)
+{
+    WaitStateSnapshot(PostStateSnapshot(snapshot, false));
+}
+
+ffrt::task_handle SocPerfThreadWrap::PostStateSnapshot(SocPerfStateSnapshot& snapshot, bool ahead)
+{
+    int64_t submitUs = SocPerfClock::GetInstance().NowUs();
+    // only copies on the queue, formatting is left to the caller so requests behind it are not held up
+    std::function<void()>&& snapshotFunc = [this, &snapshot, submitUs]() {
+        snapshot.queueWaitUs = SocPerfClock::GetInstance().NowUs() - submitUs;
+        snapshot.takenMs = SocPerfClock::GetInstance().NowMs();
+        snapshot.powerLimitBoost = powerLimitBoost_;
+        snapshot.thermalLimitBoost = thermalLimitBoost_;
+        snapshot.weakInteractionStatus = weakInteractionStatus_;
+        snapshot.performanceModeStatus = performanceModeStatus_;
+        snapshot.thermalLvl = thermalLvl_;
+        for (size_t i = 0; workerId_ == 0 && i < socPerfConfig_.interAction_.size(); i++) {
+            snapshot.interActionStatus.emplace_back(socPerfConfig_.interAction_[i]->cmdId,
+                socPerfConfig_.interAction_[i]->status);
+        }
+        for (const auto& item : holdIndex_) {
+            if (item.first.second == ACTION_TYPE_PERF) {
+                snapshot.perfHolds[item.first.first] += (int32_t)item.second.size();
+            }
+        }
+        snapshot.holdLeaks = holdLeaks_;
+        for (auto iter = resStatusInfo_.begin(); iter != resStatusInfo_.end(); ++iter) {
+            for (int32_t clientId = 0; clientId < (int32_t)limitRequest_.size(); clientId++) {
+                int64_t* value = GetLimitRequestValue(clientId, iter->first);
+                if (value != nullptr && *value != INVALID_VALUE) {
+                    snapshot.limitRequests[clientId][iter->first] = *value;
+                }
+                value = GetLimitRequestValue(clientId, iter->first + RES_ID_ADDITION);
+                if (value != nullptr && *value != INVALID_VALUE) {
+                    snapshot.limitRequests[clientId][iter->first + RES_ID_ADDITION] = *value;
+                }
+            }
+        }
+        for (const auto& item : resStatusInfo_) {
+            if (item.second == nullptr) {
+                continue;
+            }
+            ResStatus& resStatus = snapshot.resStatus.emplace(item.first, *item.second).first->second;
+            for (auto& resActionList : resStatus.resActionList) {
+                for (auto& resAction : resActionList) {
+                    resAction = std::make_shared<ResAction>(*resAction);
+                }
+            }
+        }
+    };
+    // ahead of the request backlog the caller of the dump is not blocked by it, the snapshot then may miss
+    // requests queued before it
+    ffrt::task_attr taskAttr;
+    taskAttr.priority(ahead ? ffrt_queue_priority_high : ffrt_queue_priority_low);
+    return SubmitQueueTaskH(QUEUE_TASK_SNAPSHOT, snapshotFunc, taskAttr);
+}
+
+void SocPerfThreadWrap::WaitStateSnapshot(const ffrt::task_handle& handle)
+{
+    socperfQueue_.wait(handle);
+}
+
 void SocPerfThreadWrap::SubmitStatisticsTask(
     std::function<void()> func, ffrt::task_attr& taskAttr, ffrt::task_handle& timer)
 {
-    timer = socperfQueue_.submit_h(func, taskAttr);
+    timer = SubmitQueueTaskH(QUEUE_TASK_STATISTICS, func, taskAttr);
 }
  
 void SocPerfThreadWrap::CancelStatisticsTask(ffrt::task_handle& timer)
 {
-    if (timer != nullptr) {
-        socperfQueue_.cancel(timer);
-        timer = nullptr;
+    CancelQueueTask(QUEUE_TASK_STATISTICS, timer);
+}
+
+std::function<void()> SocPerfThreadWrap::WrapQueueTask(uint8_t type, const std::function<void()>& func,
+    const ffrt::task_attr& taskAttr)
+{
+    int64_t delayUs = static_cast<int64_t>(taskAttr.delay());
+    int64_t dueUs = queueStats_.OnSubmit(type, delayUs);
+    return [this, type, func, dueUs, delayed = delayUs > 0]() {
+        int64_t startUs = queueStats_.OnStart(type, dueUs, delayed);
+        func();
+        queueStats_.OnFinish(type, startUs);
+    };
+}
+
+void SocPerfThreadWrap::SubmitQueueTask(uint8_t type, const std::function<void()>& func,
+    const ffrt::task_attr& taskAttr)
+{
+    socperfQueue_.submit(WrapQueueTask(type, func, taskAttr), taskAttr);
+}
+
+ffrt::task_handle SocPerfThreadWrap::SubmitQueueTaskH(uint8_t type, const std::function<void()>& func,
+    const ffrt::task_attr& taskAttr)
+{
+    return socperfQueue_.submit_h(WrapQueueTask(type, func, taskAttr), taskAttr);
+}
+
+void SocPerfThreadWrap::CancelQueueTask(uint8_t type, ffrt::task_handle& handle)
+{
+    if (handle == nullptr) {
+        return;
+    }
+    // only delayed timers are canceled, a timer that already started is accounted by its own run
+    if (socperfQueue_.cancel(handle) == 0) {
+        queueStats_.OnCancel(type, true);
     }
+    handle = nullptr;
+}
+
+std::string SocPerfThreadWrap::GetQueueStatsInfo()
+{
+    return queueStats_.Dump();
 }
 
 } // namespace SOCPERF
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SOCPERF_LATENCY_H
+#define SOCPERF_LATENCY_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "socperf_recorder.h"
+
+namespace OHOS {
+namespace SOCPERF {
+enum LatencyStage : uint8_t {
+    // binder receipt to the task entering the socperf queue
+    LATENCY_STAGE_ADMISSION = 0,
+    // waiting in the socperf queue
+    LATENCY_STAGE_QUEUE,
+    // dequeue to the arbitrated values being ready to send
+    LATENCY_STAGE_ARBITRATION,
+    // perf so and rss exe calls, only counted when something changed
+    LATENCY_STAGE_REPORT,
+    // binder receipt to the last backend call of the request
+    LATENCY_STAGE_TOTAL,
+    LATENCY_STAGE_MAX,
+};
+
+struct LatencyTrace {
+    uint8_t entry = 0;
+    int32_t cmdId = -1;
+    int64_t admissionUs = 0;
+    int64_t enqueueUs = 0;
+    int64_t dequeueUs = 0;
+    int64_t arbitratedUs = 0;
+    int64_t reportedUs = 0;
+};
+
+/*
+ * Log-bucketed histogram of microseconds, four sub-buckets per power of two keep the error of a
+ * percentile under 25%. Recording is a single relaxed atomic add, readers may see a slightly torn view.
+ */
+class SocPerfHistogram {
+public:
+    void Record(int64_t us);
+    uint64_t GetCount() const;
+    int64_t GetPercentile(double ratio) const;
+    void Reset();
+
+private:
+    static const int32_t SUB_BUCKET_BITS = 2;
+    static const int32_t MAX_EXPONENT = 26;
+    static const int32_t BUCKET_CNT = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) << SUB_BUCKET_BITS;
+    static int32_t GetBucket(uint64_t us);
+    static int64_t GetBucketUpper(int32_t bucket);
+    std::array<std::atomic<uint64_t>, BUCKET_CNT> buckets_ {};
+};
+
+class SocPerfLatency {
+public:
+    static SocPerfLatency& GetInstance();
+    // binder thread, the moment a request is received
+    static void MarkAdmission();
+    static void ClearAdmission();
+    static void BeginRequest(uint8_t entry, int32_t cmdId);
+    static void EndRequest();
+    // copies the request running on the calling thread, stamped as enqueued now; a request split across
+    // workers is only handed out for its first task, so every request is recorded once
+    static bool GetActiveRequest(LatencyTrace& trace);
+    // per cmdId histograms are created once so that recording never allocates or locks
+    void InitCmdIds(const std::vector<int32_t>& cmdIds);
+    void Record(const LatencyTrace& trace);
+    std::string Dump() const;
+    void Reset();
+
+private:
+    SocPerfLatency() = default;
+    void DumpHistogram(std::string& result, const std::string& name, const char* stage,
+        const SocPerfHistogram& histogram) const;
+    std::array<std::array<SocPerfHistogram, LATENCY_STAGE_MAX>, RECORD_ENTRY_MAX> entryHistograms_;
+    std::unordered_map<int32_t, std::unique_ptr<SocPerfHistogram>> cmdIdHistograms_;
+};
+
+// spans a binder entry point, a request rejected before it reaches SocPerf leaves no admission behind
+class SocPerfAdmissionScope {
+public:
+    SocPerfAdmissionScope()
+    {
+        SocPerfLatency::MarkAdmission();
+    }
+
+    ~SocPerfAdmissionScope()
+    {
+        SocPerfLatency::ClearAdmission();
+    }
+};
+
+class SocPerfLatencyScope {
+public:
+    SocPerfLatencyScope(uint8_t entry, int32_t cmdId)
+    {
+        SocPerfLatency::BeginRequest(entry, cmdId);
+    }
+
+    ~SocPerfLatencyScope()
+    {
+        SocPerfLatency::EndRequest();
+    }
+};
+} // namespace SOCPERF
+} // namespace OHOS
+#endif // SOCPERF_LATENCY_H
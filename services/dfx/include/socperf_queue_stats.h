@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SOCPERF_QUEUE_STATS_H
+#define SOCPERF_QUEUE_STATS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "socperf_latency.h"
+
+namespace OHOS {
+namespace SOCPERF {
+enum QueueTaskType : uint8_t {
+    QUEUE_TASK_INIT = 0,
+    // perf requests carrying a LatencyTrace
+    QUEUE_TASK_REQUEST,
+    // limits, limit boosts and the request switch, drained before perf requests
+    QUEUE_TASK_LIMIT,
+    // delayed release of timed perf requests
+    QUEUE_TASK_EXPIRY,
+    QUEUE_TASK_WEAK_INTERACTION,
+    QUEUE_TASK_STATUS,
+    QUEUE_TASK_REPORT_RETRY,
+    QUEUE_TASK_RECONCILE,
+    QUEUE_TASK_SNAPSHOT,
+    QUEUE_TASK_STATISTICS,
+    // device mode notifications to perf so, coalesced per mode type
+    QUEUE_TASK_SCENARIO,
+    // drops PerfRequestEx holds still alive after the maxHold of their cmd
+    QUEUE_TASK_WATCHDOG,
+    QUEUE_TASK_MAX,
+};
+
+/*
+ * Always-on counters of one serial queue. Immediate tasks form the backlog, delayed tasks are only
+ * outstanding until due, their lag is how late they start compared with the scheduled time.
+ * Every update is a relaxed atomic, readers may see a slightly torn view.
+ */
+class SocPerfQueueStats {
+public:
+    explicit SocPerfQueueStats(const char* name);
+    // returns the scheduled start time of the task, passed back to OnStart
+    int64_t OnSubmit(uint8_t type, int64_t delayUs);
+    void OnCancel(uint8_t type, bool delayed);
+    // returns the start time, passed back to OnFinish
+    int64_t OnStart(uint8_t type, int64_t dueUs, bool delayed);
+    void OnFinish(uint8_t type, int64_t startUs);
+    // request packs skipped at dequeue under backlog
+    void OnSuperseded();
+    void OnExpiredDropped();
+    int64_t GetPendingCnt() const;
+    int64_t GetMaxPendingCnt() const;
+    int64_t GetDelayedCnt(uint8_t type) const;
+    std::string Dump() const;
+    void Reset();
+
+private:
+    struct TaskStats {
+        std::atomic<uint64_t> submitted {0};
+        std::atomic<uint64_t> canceled {0};
+        std::atomic<int64_t> delayed {0};
+        std::atomic<int64_t> busyUs {0};
+        SocPerfHistogram runUs;
+        SocPerfHistogram lagUs;
+    };
+    void UpdatePendingCnt(int64_t delta);
+    std::string pendingTraceName_;
+    std::atomic<int64_t> pendingCnt_ {0};
+    std::atomic<int64_t> maxPendingCnt_ {0};
+    std::atomic<uint64_t> supersededCnt_ {0};
+    std::atomic<uint64_t> expiredDroppedCnt_ {0};
+    std::array<TaskStats, QUEUE_TASK_MAX> taskStats_;
+};
+} // namespace SOCPERF
+} // namespace OHOS
+#endif // SOCPERF_QUEUE_STATS_H
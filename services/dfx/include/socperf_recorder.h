@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOCPERF_RECORDER_H
+#define SOCPERF_RECORDER_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace OHOS {
+namespace SOCPERF {
+enum RecordEntry : uint8_t {
+    RECORD_ENTRY_PERF_REQUEST = 1,
+    RECORD_ENTRY_PERF_REQUEST_EX,
+    RECORD_ENTRY_POWER_LIMIT_BOOST,
+    RECORD_ENTRY_THERMAL_LIMIT_BOOST,
+    RECORD_ENTRY_LIMIT_REQUEST,
+    RECORD_ENTRY_SET_REQUEST_STATUS,
+    RECORD_ENTRY_SET_THERMAL_LEVEL,
+    RECORD_ENTRY_REQUEST_DEVICE_MODE,
+    RECORD_ENTRY_MAX,
+};
+
+struct SocPerfRecord {
+    uint8_t entry = 0;
+    bool onOff = false;
+    int32_t pid = 0;
+    // cmdId, clientId or thermal level, depending on entry
+    int32_t id = 0;
+    int64_t timestampUs = 0;
+    // only kept where it changes behavior: the power limit reason and the device mode
+    std::string str;
+    std::vector<int32_t> tags;
+    std::vector<int64_t> configs;
+};
+
+/*
+ * Compact binary trace of the requests entering SocPerf. The layout is little-endian:
+ * file header: magic "SPRC", uint16 version, uint16 reserved
+ * record: uint8 entry, uint8 onOff, uint16 tagCnt, int32 pid, int32 id, int64 timestampUs,
+ *         uint16 strLen, str, tagCnt * (int32 tag, int64 config)
+ */
+class SocPerfRecorder {
+public:
+    static void SetCallingPid(int32_t pid);
+    static int32_t GetCallingPid();
+    void Start();
+    void Stop();
+    bool IsRecording() const;
+    void Record(uint8_t entry, int32_t id, bool onOff, const std::string& str = "",
+        const std::vector<int32_t>& tags = {}, const std::vector<int64_t>& configs = {});
+    std::vector<uint8_t> GetData();
+    static std::string ToHex(const std::vector<uint8_t>& data);
+    static bool FromHex(const std::string& hex, std::vector<uint8_t>& data);
+    static bool Parse(const std::vector<uint8_t>& data, std::vector<SocPerfRecord>& records);
+
+private:
+    static const size_t MAX_RECORD_BUFFER_SIZE = 4 * 1024 * 1024;
+    std::atomic<bool> recording_ {false};
+    std::mutex mutex_;
+    std::vector<uint8_t> buffer_;
+    void RecordLocked(const SocPerfRecord& record);
+};
+
+// the pid stamped on what one call into SocPerf records, reset when the call returns
+class SocPerfCallingPidScope {
+public:
+    explicit SocPerfCallingPidScope(int32_t pid)
+    {
+        SocPerfRecorder::SetCallingPid(pid);
+    }
+
+    ~SocPerfCallingPidScope()
+    {
+        SocPerfRecorder::SetCallingPid(0);
+    }
+};
+} // namespace SOCPERF
+} // namespace OHOS
+#endif // SOCPERF_RECORDER_H
@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "socperf_latency.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+#include "socperf_clock.h"
+
+namespace OHOS {
+namespace SOCPERF {
+namespace {
+    const double PERCENTILE_50 = 0.5;
+    const double PERCENTILE_99 = 0.99;
+    const double PERCENTILE_999 = 0.999;
+    const int32_t DUMP_LINE_LEN = 128;
+    const char* const ENTRY_NAMES[RECORD_ENTRY_MAX] = { "", "PerfRequest", "PerfRequestEx", "PowerLimitBoost",
+        "ThermalLimitBoost", "LimitRequest", "SetRequestStatus", "SetThermalLevel", "RequestDeviceMode" };
+    const char* const STAGE_NAMES[LATENCY_STAGE_MAX] = { "admission", "queue", "arbitration", "report", "total" };
+
+    thread_local int64_t g_admissionUs = 0;
+    thread_local bool g_requestActive = false;
+    thread_local bool g_requestTraced = false;
+    thread_local LatencyTrace g_activeTrace;
+
+    int32_t Log2(uint64_t value)
+    {
+        int32_t exponent = 0;
+        while (value >>= 1) {
+            exponent++;
+        }
+        return exponent;
+    }
+}
+
+int32_t SocPerfHistogram::GetBucket(uint64_t us)
+{
+    const uint64_t subBucketCnt = 1ULL << SUB_BUCKET_BITS;
+    if (us < subBucketCnt) {
+        return static_cast<int32_t>(us);
+    }
+    us = std::min<uint64_t>(us, (1ULL << (MAX_EXPONENT + 1)) - 1);
+    int32_t exponent = Log2(us);
+    int32_t sub = static_cast<int32_t>((us >> (exponent - SUB_BUCKET_BITS)) & (subBucketCnt - 1));
+    return ((exponent - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS) + sub;
+}
+
+int64_t SocPerfHistogram::GetBucketUpper(int32_t bucket)
+{
+    const int32_t subBucketCnt = 1 << SUB_BUCKET_BITS;
+    if (bucket < subBucketCnt) {
+        return bucket;
+    }
+    int32_t exponent = (bucket >> SUB_BUCKET_BITS) + SUB_BUCKET_BITS - 1;
+    int64_t width = 1LL << (exponent - SUB_BUCKET_BITS);
+    int64_t lower = (1LL << exponent) + (bucket & (subBucketCnt - 1)) * width;
+    return lower + width - 1;
+}
+
+void SocPerfHistogram::Record(int64_t us)
+{
+    buckets_[GetBucket(static_cast<uint64_t>(std::max<int64_t>(us, 0)))].fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t SocPerfHistogram::GetCount() const
+{
+    uint64_t count = 0;
+    for (const auto& bucket : buckets_) {
+        count += bucket.load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+int64_t SocPerfHistogram::GetPercentile(double ratio) const
+{
+    std::array<uint64_t, BUCKET_CNT> counts;
+    uint64_t total = 0;
+    for (int32_t i = 0; i < BUCKET_CNT; i++) {
+        counts[i] = buckets_[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = std::max<uint64_t>(static_cast<uint64_t>(total * ratio + 0.5), 1);
+    uint64_t seen = 0;
+    for (int32_t i = 0; i < BUCKET_CNT; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return GetBucketUpper(i);
+        }
+    }
+    return GetBucketUpper(BUCKET_CNT - 1);
+}
+
+void SocPerfHistogram::Reset()
+{
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+SocPerfLatency& SocPerfLatency::GetInstance()
+{
+    static SocPerfLatency instance;
+    return instance;
+}
+
+void SocPerfLatency::MarkAdmission()
+{
+    g_admissionUs = SocPerfClock::GetInstance().NowUs();
+}
+
+void SocPerfLatency::ClearAdmission()
+{
+    g_admissionUs = 0;
+}
+
+void SocPerfLatency::BeginRequest(uint8_t entry, int32_t cmdId)
+{
+    int64_t nowUs = SocPerfClock::GetInstance().NowUs();
+    g_activeTrace = LatencyTrace();
+    g_activeTrace.entry = entry;
+    g_activeTrace.cmdId = cmdId;
+    // calls from inside the service have no binder receipt, they are admitted on entry
+    g_activeTrace.admissionUs = g_admissionUs != 0 ? g_admissionUs : nowUs;
+    g_admissionUs = 0;
+    g_requestActive = true;
+    g_requestTraced = false;
+}
+
+void SocPerfLatency::EndRequest()
+{
+    g_requestActive = false;
+}
+
+bool SocPerfLatency::GetActiveRequest(LatencyTrace& trace)
+{
+    if (!g_requestActive || g_requestTraced) {
+        return false;
+    }
+    g_requestTraced = true;
+    trace = g_activeTrace;
+    trace.enqueueUs = SocPerfClock::GetInstance().NowUs();
+    return true;
+}
+
+void SocPerfLatency::InitCmdIds(const std::vector<int32_t>& cmdIds)
+{
+    for (int32_t cmdId : cmdIds) {
+        if (cmdIdHistograms_.find(cmdId) == cmdIdHistograms_.end()) {
+            cmdIdHistograms_[cmdId] = std::make_unique<SocPerfHistogram>();
+        }
+    }
+}
+
+void SocPerfLatency::Record(const LatencyTrace& trace)
+{
+    if (trace.entry == 0 || trace.entry >= RECORD_ENTRY_MAX) {
+        return;
+    }
+    auto& histograms = entryHistograms_[trace.entry];
+    int64_t endUs = trace.reportedUs != 0 ? trace.reportedUs : trace.arbitratedUs;
+    histograms[LATENCY_STAGE_ADMISSION].Record(trace.enqueueUs - trace.admissionUs);
+    histograms[LATENCY_STAGE_QUEUE].Record(trace.dequeueUs - trace.enqueueUs);
+    histograms[LATENCY_STAGE_ARBITRATION].Record(trace.arbitratedUs - trace.dequeueUs);
+    if (trace.reportedUs != 0) {
+        histograms[LATENCY_STAGE_REPORT].Record(trace.reportedUs - trace.arbitratedUs);
+    }
+    histograms[LATENCY_STAGE_TOTAL].Record(endUs - trace.admissionUs);
+    auto iter = cmdIdHistograms_.find(trace.cmdId);
+    if (iter != cmdIdHistograms_.end()) {
+        iter->second->Record(endUs - trace.admissionUs);
+    }
+}
+
+void SocPerfLatency::DumpHistogram(std::string& result, const std::string& name, const char* stage,
+    const SocPerfHistogram& histogram) const
+{
+    uint64_t count = histogram.GetCount();
+    if (count == 0) {
+        return;
+    }
+    char line[DUMP_LINE_LEN];
+    int ret = snprintf(line, sizeof(line), "%-20s %-12s %10" PRIu64 " %10" PRId64 " %10" PRId64 " %10" PRId64 "\n",
+        name.c_str(), stage, count, histogram.GetPercentile(PERCENTILE_50),
+        histogram.GetPercentile(PERCENTILE_99), histogram.GetPercentile(PERCENTILE_999));
+    if (ret > 0) {
+        result.append(line);
+    }
+}
+
+std::string SocPerfLatency::Dump() const
+{
+    std::string result;
+    char line[DUMP_LINE_LEN];
+    int ret = snprintf(line, sizeof(line), "%-20s %-12s %10s %10s %10s %10s\n", "latency(us)", "stage", "count",
+        "p50", "p99", "p999");
+    if (ret > 0) {
+        result.append(line);
+    }
+    for (int32_t entry = RECORD_ENTRY_PERF_REQUEST; entry < RECORD_ENTRY_MAX; entry++) {
+        for (int32_t stage = LATENCY_STAGE_ADMISSION; stage < LATENCY_STAGE_MAX; stage++) {
+            DumpHistogram(result, ENTRY_NAMES[entry], STAGE_NAMES[stage], entryHistograms_[entry][stage]);
+        }
+    }
+    std::vector<int32_t> cmdIds;
+    for (const auto& item : cmdIdHistograms_) {
+        cmdIds.push_back(item.first);
+    }
+    std::sort(cmdIds.begin(), cmdIds.end());
+    for (int32_t cmdId : cmdIds) {
+        DumpHistogram(result, "cmdId " + std::to_string(cmdId), STAGE_NAMES[LATENCY_STAGE_TOTAL],
+            *cmdIdHistograms_.at(cmdId));
+    }
+    return result;
+}
+
+void SocPerfLatency::Reset()
+{
+    for (auto& histograms : entryHistograms_) {
+        for (auto& histogram : histograms) {
+            histogram.Reset();
+        }
+    }
+    for (auto& item : cmdIdHistograms_) {
+        item.second->Reset();
+    }
+}
+} // namespace SOCPERF
+} // namespace OHOS
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "socperf_queue_stats.h"
+
+#include <cinttypes>
+#include <cstdio>
+
+#include "socperf_clock.h"
+#include "socperf_trace.h"
+
+namespace OHOS {
+namespace SOCPERF {
+namespace {
+    const double PERCENTILE_50 = 0.5;
+    const double PERCENTILE_99 = 0.99;
+    const int32_t DUMP_LINE_LEN = 160;
+    const char* const TASK_TYPE_NAMES[QUEUE_TASK_MAX] = { "init", "request", "limit", "expiry", "weak_interaction",
+        "status", "report_retry", "reconcile", "snapshot", "statistics", "scenario", "watchdog" };
+}
+
+SocPerfQueueStats::SocPerfQueueStats(const char* name) : pendingTraceName_(std::string(name) + "_pending")
+{
+}
+
+int64_t SocPerfQueueStats::OnSubmit(uint8_t type, int64_t delayUs)
+{
+    int64_t nowUs = SocPerfClock::GetInstance().NowUs();
+    if (type >= QUEUE_TASK_MAX) {
+        return nowUs;
+    }
+    taskStats_[type].submitted.fetch_add(1, std::memory_order_relaxed);
+    if (delayUs > 0) {
+        taskStats_[type].delayed.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        UpdatePendingCnt(1);
+    }
+    return nowUs + delayUs;
+}
+
+void SocPerfQueueStats::OnCancel(uint8_t type, bool delayed)
+{
+    if (type >= QUEUE_TASK_MAX) {
+        return;
+    }
+    taskStats_[type].canceled.fetch_add(1, std::memory_order_relaxed);
+    if (delayed) {
+        taskStats_[type].delayed.fetch_sub(1, std::memory_order_relaxed);
+    } else {
+        UpdatePendingCnt(-1);
+    }
+}
+
+int64_t SocPerfQueueStats::OnStart(uint8_t type, int64_t dueUs, bool delayed)
+{
+    int64_t nowUs = SocPerfClock::GetInstance().NowUs();
+    if (type >= QUEUE_TASK_MAX) {
+        return nowUs;
+    }
+    if (delayed) {
+        taskStats_[type].delayed.fetch_sub(1, std::memory_order_relaxed);
+        taskStats_[type].lagUs.Record(nowUs - dueUs);
+    } else {
+        UpdatePendingCnt(-1);
+    }
+    return nowUs;
+}
+
+void SocPerfQueueStats::OnFinish(uint8_t type, int64_t startUs)
+{
+    if (type >= QUEUE_TASK_MAX) {
+        return;
+    }
+    int64_t runUs = SocPerfClock::GetInstance().NowUs() - startUs;
+    taskStats_[type].runUs.Record(runUs);
+    taskStats_[type].busyUs.fetch_add(runUs, std::memory_order_relaxed);
+}
+
+void SocPerfQueueStats::OnSuperseded()
+{
+    supersededCnt_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SocPerfQueueStats::OnExpiredDropped()
+{
+    expiredDroppedCnt_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SocPerfQueueStats::UpdatePendingCnt(int64_t delta)
+{
+    int64_t pendingCnt = pendingCnt_.fetch_add(delta, std::memory_order_relaxed) + delta;
+    int64_t maxPendingCnt = maxPendingCnt_.load(std::memory_order_relaxed);
+    while (pendingCnt > maxPendingCnt &&
+        !maxPendingCnt_.compare_exchange_weak(maxPendingCnt, pendingCnt, std::memory_order_relaxed)) {
+    }
+    CountTraceEx(HITRACE_LEVEL_INFO, HITRACE_TAG_SOCPERF, pendingTraceName_.c_str(), pendingCnt);
+}
+
+int64_t SocPerfQueueStats::GetPendingCnt() const
+{
+    return pendingCnt_.load(std::memory_order_relaxed);
+}
+
+int64_t SocPerfQueueStats::GetMaxPendingCnt() const
+{
+    return maxPendingCnt_.load(std::memory_order_relaxed);
+}
+
+int64_t SocPerfQueueStats::GetDelayedCnt(uint8_t type) const
+{
+    if (type >= QUEUE_TASK_MAX) {
+        return 0;
+    }
+    return taskStats_[type].delayed.load(std::memory_order_relaxed);
+}
+
+std::string SocPerfQueueStats::Dump() const
+{
+    std::string result;
+    result.append("pending: ").append(std::to_string(GetPendingCnt()))
+        .append(", max pending: ").append(std::to_string(GetMaxPendingCnt()))
+        .append(", superseded packs: ").append(std::to_string(supersededCnt_.load(std::memory_order_relaxed)))
+        .append(", expired actions dropped: ")
+        .append(std::to_string(expiredDroppedCnt_.load(std::memory_order_relaxed))).append("\n");
+    char line[DUMP_LINE_LEN];
+    int ret = snprintf(line, sizeof(line), "%-18s %10s %10s %8s %12s %10s %10s %10s %10s\n", "task(us)", "submitted",
+        "canceled", "delayed", "busy", "run_p50", "run_p99", "lag_p50", "lag_p99");
+    if (ret > 0) {
+        result.append(line);
+    }
+    for (int32_t type = QUEUE_TASK_INIT; type < QUEUE_TASK_MAX; type++) {
+        const TaskStats& stats = taskStats_[type];
+        uint64_t submitted = stats.submitted.load(std::memory_order_relaxed);
+        int64_t delayed = stats.delayed.load(std::memory_order_relaxed);
+        if (submitted == 0 && delayed == 0) {
+            continue;
+        }
+        ret = snprintf(line, sizeof(line), "%-18s %10" PRIu64 " %10" PRIu64 " %8" PRId64 " %12" PRId64
+            " %10" PRId64 " %10" PRId64 " %10" PRId64 " %10" PRId64 "\n", TASK_TYPE_NAMES[type], submitted,
+            stats.canceled.load(std::memory_order_relaxed), delayed,
+            stats.busyUs.load(std::memory_order_relaxed), stats.runUs.GetPercentile(PERCENTILE_50),
+            stats.runUs.GetPercentile(PERCENTILE_99), stats.lagUs.GetPercentile(PERCENTILE_50),
+            stats.lagUs.GetPercentile(PERCENTILE_99));
+        if (ret > 0) {
+            result.append(line);
+        }
+    }
+    return result;
+}
+
+void SocPerfQueueStats::Reset()
+{
+    // pending and delayed counts describe tasks still in the queue, only the history is cleared
+    maxPendingCnt_.store(pendingCnt_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    supersededCnt_.store(0, std::memory_order_relaxed);
+    expiredDroppedCnt_.store(0, std::memory_order_relaxed);
+    for (auto& stats : taskStats_) {
+        stats.submitted.store(0, std::memory_order_relaxed);
+        stats.canceled.store(0, std::memory_order_relaxed);
+        stats.busyUs.store(0, std::memory_order_relaxed);
+        stats.runUs.Reset();
+        stats.lagUs.Reset();
+    }
+}
+} // namespace SOCPERF
+} // namespace OHOS
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "socperf_recorder.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "socperf_clock.h"
+#include "socperf_log.h"
+
+namespace OHOS {
+namespace SOCPERF {
+namespace {
+    const char RECORD_MAGIC[] = { 'S', 'P', 'R', 'C' };
+    const uint16_t RECORD_VERSION = 1;
+    const size_t RECORD_HEADER_SIZE = sizeof(RECORD_MAGIC) + sizeof(uint16_t) + sizeof(uint16_t);
+    const size_t RECORD_FIXED_SIZE = sizeof(uint8_t) + sizeof(uint8_t) + sizeof(uint16_t) + sizeof(int32_t) +
+        sizeof(int32_t) + sizeof(int64_t) + sizeof(uint16_t);
+    const size_t RECORD_TAG_SIZE = sizeof(int32_t) + sizeof(int64_t);
+    const size_t MAX_RECORD_FIELD_CNT = 0xFFFF;
+    const uint32_t BITS_PER_BYTE = 8;
+    const uint32_t BITS_PER_HEX = 4;
+    const size_t HEX_CHARS_PER_BYTE = 2;
+    const uint8_t HEX_MASK = 0x0F;
+    const uint8_t HEX_DIGIT_BASE = 10;
+    const char HEX_CHARS[] = "0123456789abcdef";
+    thread_local int32_t g_callingPid = 0;
+
+    template<typename T>
+    void Append(std::vector<uint8_t>& buffer, T value)
+    {
+        for (size_t i = 0; i < sizeof(T); i++) {
+            buffer.push_back(static_cast<uint8_t>(static_cast<uint64_t>(value) >> (i * BITS_PER_BYTE)));
+        }
+    }
+
+    template<typename T>
+    bool Read(const std::vector<uint8_t>& buffer, size_t& pos, T& value)
+    {
+        if (pos + sizeof(T) > buffer.size()) {
+            return false;
+        }
+        uint64_t raw = 0;
+        for (size_t i = 0; i < sizeof(T); i++) {
+            raw |= static_cast<uint64_t>(buffer[pos + i]) << (i * BITS_PER_BYTE);
+        }
+        value = static_cast<T>(raw);
+        pos += sizeof(T);
+        return true;
+    }
+
+    int32_t HexValue(char c)
+    {
+        if (c >= '0' && c <= '9') {
+            return c - '0';
+        }
+        if (c >= 'a' && c <= 'f') {
+            return c - 'a' + HEX_DIGIT_BASE;
+        }
+        if (c >= 'A' && c <= 'F') {
+            return c - 'A' + HEX_DIGIT_BASE;
+        }
+        return -1;
+    }
+}
+
+void SocPerfRecorder::SetCallingPid(int32_t pid)
+{
+    g_callingPid = pid;
+}
+
+int32_t SocPerfRecorder::GetCallingPid()
+{
+    return g_callingPid;
+}
+
+void SocPerfRecorder::Start()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffer_.assign(std::begin(RECORD_MAGIC), std::end(RECORD_MAGIC));
+    Append<uint16_t>(buffer_, RECORD_VERSION);
+    Append<uint16_t>(buffer_, 0);
+    recording_ = true;
+    SOC_PERF_LOGI("request recorder started");
+}
+
+void SocPerfRecorder::Stop()
+{
+    recording_ = false;
+    SOC_PERF_LOGI("request recorder stopped");
+}
+
+bool SocPerfRecorder::IsRecording() const
+{
+    return recording_.load(std::memory_order_relaxed);
+}
+
+void SocPerfRecorder::Record(uint8_t entry, int32_t id, bool onOff, const std::string& str,
+    const std::vector<int32_t>& tags, const std::vector<int64_t>& configs)
+{
+    if (!IsRecording()) {
+        return;
+    }
+    SocPerfRecord record;
+    record.entry = entry;
+    record.onOff = onOff;
+    record.pid = g_callingPid;
+    record.id = id;
+    record.timestampUs = SocPerfClock::GetInstance().NowUs();
+    record.str = str.substr(0, MAX_RECORD_FIELD_CNT);
+    record.tags = tags;
+    record.configs = configs;
+    std::lock_guard<std::mutex> lock(mutex_);
+    RecordLocked(record);
+}
+
+void SocPerfRecorder::RecordLocked(const SocPerfRecord& record)
+{
+    size_t tagCnt = std::min(std::min(record.tags.size(), record.configs.size()), MAX_RECORD_FIELD_CNT);
+    size_t size = RECORD_FIXED_SIZE + record.str.size() + tagCnt * RECORD_TAG_SIZE;
+    if (!recording_ || buffer_.size() + size > MAX_RECORD_BUFFER_SIZE) {
+        // keep the beginning of the trace, the request sequence is only replayable from its start
+        if (recording_) {
+            SOC_PERF_LOGW("request recorder buffer is full, stop recording");
+        }
+        recording_ = false;
+        return;
+    }
+    Append<uint8_t>(buffer_, record.entry);
+    Append<uint8_t>(buffer_, record.onOff ? 1 : 0);
+    Append<uint16_t>(buffer_, static_cast<uint16_t>(tagCnt));
+    Append<int32_t>(buffer_, record.pid);
+    Append<int32_t>(buffer_, record.id);
+    Append<int64_t>(buffer_, record.timestampUs);
+    Append<uint16_t>(buffer_, static_cast<uint16_t>(record.str.size()));
+    buffer_.insert(buffer_.end(), record.str.begin(), record.str.end());
+    for (size_t i = 0; i < tagCnt; i++) {
+        Append<int32_t>(buffer_, record.tags[i]);
+        Append<int64_t>(buffer_, record.configs[i]);
+    }
+}
+
+std::vector<uint8_t> SocPerfRecorder::GetData()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return buffer_;
+}
+
+std::string SocPerfRecorder::ToHex(const std::vector<uint8_t>& data)
+{
+    std::string hex;
+    hex.reserve(data.size() * HEX_CHARS_PER_BYTE);
+    for (uint8_t byte : data) {
+        hex.push_back(HEX_CHARS[byte >> BITS_PER_HEX]);
+        hex.push_back(HEX_CHARS[byte & HEX_MASK]);
+    }
+    return hex;
+}
+
+bool SocPerfRecorder::FromHex(const std::string& hex, std::vector<uint8_t>& data)
+{
+    int32_t high = -1;
+    for (char c : hex) {
+        int32_t value = HexValue(c);
+        if (value < 0) {
+            // dump output is wrapped into lines
+            if (c == '\n' || c == '\r' || c == ' ') {
+                continue;
+            }
+            return false;
+        }
+        if (high < 0) {
+            high = value;
+        } else {
+            data.push_back(static_cast<uint8_t>((high << BITS_PER_HEX) | value));
+            high = -1;
+        }
+    }
+    return high < 0;
+}
+
+bool SocPerfRecorder::Parse(const std::vector<uint8_t>& data, std::vector<SocPerfRecord>& records)
+{
+    if (data.size() < RECORD_HEADER_SIZE || memcmp(data.data(), RECORD_MAGIC, sizeof(RECORD_MAGIC)) != 0) {
+        return false;
+    }
+    size_t pos = sizeof(RECORD_MAGIC);
+    uint16_t version = 0;
+    uint16_t reserved = 0;
+    if (!Read(data, pos, version) || !Read(data, pos, reserved) || version != RECORD_VERSION) {
+        return false;
+    }
+    while (pos < data.size()) {
+        SocPerfRecord record;
+        uint8_t onOff = 0;
+        uint16_t tagCnt = 0;
+        uint16_t strLen = 0;
+        if (!Read(data, pos, record.entry) || !Read(data, pos, onOff) || !Read(data, pos, tagCnt) ||
+            !Read(data, pos, record.pid) || !Read(data, pos, record.id) || !Read(data, pos, record.timestampUs) ||
+            !Read(data, pos, strLen) || pos + strLen > data.size()) {
+            return false;
+        }
+        record.onOff = onOff != 0;
+        record.str.assign(data.begin() + pos, data.begin() + pos + strLen);
+        pos += strLen;
+        for (uint16_t i = 0; i < tagCnt; i++) {
+            int32_t tag = 0;
+            int64_t config = 0;
+            if (!Read(data, pos, tag) || !Read(data, pos, config)) {
+                return false;
+            }
+            record.tags.push_back(tag);
+            record.configs.push_back(config);
+        }
+        records.push_back(record);
+    }
+    return true;
+}
+} // namespace SOCPERF
+} // namespace OHOS
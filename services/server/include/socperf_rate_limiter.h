@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOCPERF_RATE_LIMITER_H
+#define SOCPERF_RATE_LIMITER_H
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "socperf_common.h"
+
+namespace OHOS {
+namespace SOCPERF {
+/*
+ * Admission of perf requests per caller, checked before they reach SocPerf:
+ * a token bucket per caller and cmdId class bounds the request rate, and the boost time charged to
+ * a caller within a sliding window bounds how long it keeps the soc boosted. Releases are never limited.
+ */
+class SocPerfRateLimiter {
+public:
+    void Init(const std::vector<std::shared_ptr<RateLimitClass>>& classes, int32_t windowMs, int32_t budgetMs,
+        const std::unordered_map<int32_t, std::shared_ptr<Actions>>& actionsInfo);
+    // a PerfRequest or PerfRequestEx on, false when the caller is over its rate or budget
+    bool Acquire(uint32_t callerId, int32_t cmdId);
+    // a PerfRequestEx on that SocPerf accepted, its time is charged from now until the release
+    void Hold(uint32_t callerId, int32_t cmdId);
+    // a PerfRequestEx off or a hold released for a dead caller, the held time is charged to the budget
+    void Release(uint32_t callerId, int32_t cmdId);
+    // all perf requests were cleared, every open hold ends now
+    void ReleaseAll();
+    std::string Dump();
+
+private:
+    static const int64_t MILLI_TOKENS_PER_TOKEN = 1000;
+    static const size_t MAX_CALLER_CNT = 256;
+
+    struct RateLimitCmd {
+        int32_t classId = -1;
+        // longest timed action, charged when the request is accepted
+        int64_t boostMs = 0;
+        // the cmd has actions kept until the off, their held time is charged instead
+        bool longTime = false;
+        int32_t maxHoldMs = 0;
+    };
+
+    struct TokenBucket {
+        int64_t milliTokens = 0;
+        int64_t refillMs = 0;
+    };
+
+    struct CallerState {
+        std::vector<TokenBucket> buckets;
+        // boost time charged at each time point, oldest first, and their sum
+        std::deque<std::pair<int64_t, int64_t>> charges;
+        int64_t chargedMs = 0;
+        // start of each open long-time hold by cmdId
+        std::unordered_map<int32_t, int64_t> holds;
+        int64_t lastMs = 0;
+        uint64_t rateRejected = 0;
+        uint64_t budgetRejected = 0;
+    };
+
+    bool enabled_ = false;
+    std::vector<std::shared_ptr<RateLimitClass>> classes_;
+    int32_t defaultClassId_ = -1;
+    int32_t windowMs_ = 0;
+    int32_t budgetMs_ = 0;
+    std::unordered_map<int32_t, RateLimitCmd> cmds_;
+    std::mutex mutex_;
+    std::unordered_map<uint32_t, CallerState> callers_;
+
+    CallerState& GetCallerState(uint32_t callerId, int64_t nowMs);
+    bool TakeToken(CallerState& caller, int32_t classId, int64_t nowMs);
+    int64_t GetUsedBudget(CallerState& caller, int64_t nowMs);
+    int64_t GetHeldMs(int32_t cmdId, int64_t startMs, int64_t nowMs) const;
+    void Charge(CallerState& caller, int64_t boostMs, int64_t nowMs);
+};
+} // namespace SOCPERF
+} // namespace OHOS
+#endif // SOCPERF_RATE_LIMITER_H
@@ -16,11 +16,14 @@
 #ifndef SOC_PERF_SERVICES_SERVER_INCLUDE_SOCPERF_SERVER_H
 #define SOC_PERF_SERVICES_SERVER_INCLUDE_SOCPERF_SERVER_H
 
+#include <map>
+#include <unordered_map>
 #include "singleton.h"
 #include "soc_perf_stub.h"
 #include "socperf.h"
 #include "system_ability.h"
 #include "socperf_lru_cache.h"
+#include "socperf_rate_limiter.h"
 #include "tokenid_kit.h"
 #include "accesstoken_kit.h"
 
@@ -107,6 +110,12 @@ public:
      * @param funcResult return cmdId count, as 10000:xx,10001:xx
      */
     virtual ErrCode RequestCmdIdCount(const std::string& msg, std::string& funcResult) override;
+
+    /**
+     * @brief register the calling process, its holds are released when the token dies
+     * @param clientToken object owned by the client process, used for the death notification
+     */
+    virtual ErrCode RegisterClient(const sptr<IRemoteObject>& clientToken) override;
     int32_t Dump(int32_t fd, const std::vector<std::u16string>& args) override;
 
 public:
@@ -116,12 +125,46 @@ protected:
     void OnStart() override;
     void OnStop() override;
 
+private:
+    class ClientDeathRecipient : public IRemoteObject::DeathRecipient {
+    public:
+        ClientDeathRecipient(SocPerfServer& socPerfServer, int32_t pid);
+        void OnRemoteDied(const wptr<IRemoteObject>& object) override;
+
+    private:
+        SocPerfServer& socPerfServer_;
+        int32_t pid_;
+    };
+
+    struct ClientHolds {
+        AccessToken::AccessTokenID tokenId = 0;
+        sptr<IRemoteObject> clientToken;
+        sptr<IRemoteObject::DeathRecipient> recipient;
+        // PerfRequestEx holds not turned off yet, by the cmdId SocPerf matched them to, which keeps a single hold
+        // per matched cmdId; the value is the cmdId the client asked for, its rate limiter hold is kept under it
+        std::map<int32_t, int32_t> perfHolds;
+    };
+
 private:
     SocPerf socPerf;
+    SocPerfRateLimiter rateLimiter_;
     std::mutex permissionCacheMutex_;
     bool AllowDump();
+    std::string DumpRecord(const std::string& option);
+    std::string DumpClientHolds();
     bool HasPerfPermission();
+    void RecordPerfHold(int32_t pid, int32_t cmdId, int32_t matchCmdId, bool onOffTag);
+    void RecordLimitHold(int32_t pid, int32_t clientId,
+        const std::vector<int32_t>& tags, const std::vector<int64_t>& configs);
+    void ClearPerfHolds();
+    void ReleaseClientHolds(int32_t pid, const IRemoteObject::DeathRecipient* recipient);
+    std::vector<int32_t> GetOrphanPerfHolds(int32_t pid);
     SocPerfLRUCache<AccessToken::AccessTokenID, int32_t> permissionCache_;
+    std::mutex clientHoldsMutex_;
+    // registered client processes by pid
+    std::unordered_map<int32_t, ClientHolds> clientHolds_;
+    // registered pid that last set a LimitRequest value, by (clientId, resId)
+    std::map<std::pair<int32_t, int32_t>, int32_t> limitOwners_;
 };
 } // namespace SOCPERF
 } // namespace OHOS
@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "socperf_rate_limiter.h"
+
+#include <algorithm>
+
+#include "socperf_clock.h"
+#include "socperf_log.h"
+
+namespace OHOS {
+namespace SOCPERF {
+namespace {
+    // charges closer than this are merged, the window is only as precise
+    const int64_t CHARGE_MERGE_MS = 100;
+    const int64_t MS_PER_SECOND = 1000;
+}
+
+void SocPerfRateLimiter::Init(const std::vector<std::shared_ptr<RateLimitClass>>& classes, int32_t windowMs,
+    int32_t budgetMs, const std::unordered_map<int32_t, std::shared_ptr<Actions>>& actionsInfo)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    classes_ = classes;
+    windowMs_ = windowMs > 0 && budgetMs > 0 ? windowMs : 0;
+    budgetMs_ = windowMs_ > 0 ? budgetMs : 0;
+    defaultClassId_ = -1;
+    cmds_.clear();
+    callers_.clear();
+    for (int32_t classId = 0; classId < (int32_t)classes_.size(); classId++) {
+        if (classes_[classId]->cmdIds.empty()) {
+            defaultClassId_ = classId;
+        }
+        for (int32_t cmdId : classes_[classId]->cmdIds) {
+            cmds_[cmdId].classId = classId;
+        }
+    }
+    for (const auto& item : actionsInfo) {
+        if (item.second == nullptr) {
+            continue;
+        }
+        RateLimitCmd& cmd = cmds_[item.first];
+        for (const auto& action : item.second->actionList) {
+            if (action->duration == 0) {
+                cmd.longTime = true;
+            } else {
+                cmd.boostMs = std::max(cmd.boostMs, (int64_t)action->duration);
+            }
+        }
+        cmd.maxHoldMs = item.second->maxHoldMs;
+    }
+    enabled_ = !classes_.empty() || budgetMs_ > 0;
+    SOC_PERF_LOGI("rate limit classes %{public}zu, budget %{public}dms in %{public}dms",
+        classes_.size(), budgetMs_, windowMs_);
+}
+
+bool SocPerfRateLimiter::Acquire(uint32_t callerId, int32_t cmdId)
+{
+    if (!enabled_) {
+        return true;
+    }
+    int64_t nowMs = SocPerfClock::GetInstance().NowMs();
+    RateLimitCmd cmd;
+    auto cmdIter = cmds_.find(cmdId);
+    if (cmdIter != cmds_.end()) {
+        cmd = cmdIter->second;
+    }
+    int32_t classId = cmd.classId >= 0 ? cmd.classId : defaultClassId_;
+    std::lock_guard<std::mutex> lock(mutex_);
+    CallerState& caller = GetCallerState(callerId, nowMs);
+    // the budget goes first so a rejected request does not spend a token
+    if (budgetMs_ > 0 && GetUsedBudget(caller, nowMs) >= budgetMs_) {
+        caller.budgetRejected++;
+        SOC_PERF_LOGD("caller %{public}u is over its boost budget, cmdId %{public}d", callerId, cmdId);
+        return false;
+    }
+    if (classId >= 0 && !TakeToken(caller, classId, nowMs)) {
+        caller.rateRejected++;
+        SOC_PERF_LOGD("caller %{public}u is over the rate of %{public}s, cmdId %{public}d",
+            callerId, classes_[classId]->name.c_str(), cmdId);
+        return false;
+    }
+    if (cmd.boostMs > 0) {
+        Charge(caller, cmd.boostMs, nowMs);
+    }
+    return true;
+}
+
+void SocPerfRateLimiter::Hold(uint32_t callerId, int32_t cmdId)
+{
+    if (!enabled_) {
+        return;
+    }
+    auto cmdIter = cmds_.find(cmdId);
+    if (cmdIter == cmds_.end() || !cmdIter->second.longTime) {
+        return;
+    }
+    int64_t nowMs = SocPerfClock::GetInstance().NowMs();
+    std::lock_guard<std::mutex> lock(mutex_);
+    // an on repeated before the off replaces the same hold, it is timed from the first one
+    GetCallerState(callerId, nowMs).holds.emplace(cmdId, nowMs);
+}
+
+void SocPerfRateLimiter::Release(uint32_t callerId, int32_t cmdId)
+{
+    if (!enabled_) {
+        return;
+    }
+    int64_t nowMs = SocPerfClock::GetInstance().NowMs();
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto callerIter = callers_.find(callerId);
+    if (callerIter == callers_.end()) {
+        return;
+    }
+    CallerState& caller = callerIter->second;
+    auto holdIter = caller.holds.find(cmdId);
+    if (holdIter == caller.holds.end()) {
+        return;
+    }
+    Charge(caller, GetHeldMs(cmdId, holdIter->second, nowMs), nowMs);
+    caller.holds.erase(holdIter);
+}
+
+void SocPerfRateLimiter::ReleaseAll()
+{
+    if (!enabled_) {
+        return;
+    }
+    int64_t nowMs = SocPerfClock::GetInstance().NowMs();
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& item : callers_) {
+        CallerState& caller = item.second;
+        for (const auto& hold : caller.holds) {
+            Charge(caller, GetHeldMs(hold.first, hold.second, nowMs), nowMs);
+        }
+        caller.holds.clear();
+    }
+}
+
+std::string SocPerfRateLimiter::Dump()
+{
+    if (!enabled_) {
+        return "rate limit: off\n";
+    }
+    int64_t nowMs = SocPerfClock::GetInstance().NowMs();
+    std::string result("rate limit: budget ");
+    result.append(std::to_string(budgetMs_)).append("ms in ").append(std::to_string(windowMs_)).append("ms");
+    for (const auto& rateLimitClass : classes_) {
+        result.append(", ").append(rateLimitClass->name).append(" ")
+            .append(std::to_string(rateLimitClass->rate)).append("/s burst ")
+            .append(std::to_string(rateLimitClass->burst));
+    }
+    result.append("\n");
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& item : callers_) {
+        CallerState& caller = item.second;
+        result.append("    caller ").append(std::to_string(item.first))
+            .append(": used ").append(std::to_string(GetUsedBudget(caller, nowMs))).append("ms")
+            .append(", holds ").append(std::to_string(caller.holds.size()))
+            .append(", rejected rate ").append(std::to_string(caller.rateRejected))
+            .append(" budget ").append(std::to_string(caller.budgetRejected)).append("\n");
+    }
+    return result;
+}
+
+SocPerfRateLimiter::CallerState& SocPerfRateLimiter::GetCallerState(uint32_t callerId, int64_t nowMs)
+{
+    auto iter = callers_.find(callerId);
+    if (iter == callers_.end()) {
+        if (callers_.size() >= MAX_CALLER_CNT) {
+            // a caller idle for the whole window has a full bucket and nothing charged, it starts over the same
+            for (auto idleIter = callers_.begin(); idleIter != callers_.end();) {
+                bool idle = idleIter->second.holds.empty() && nowMs - idleIter->second.lastMs > windowMs_ &&
+                    GetUsedBudget(idleIter->second, nowMs) == 0;
+                idleIter = idle ? callers_.erase(idleIter) : std::next(idleIter);
+            }
+        }
+        if (callers_.size() >= MAX_CALLER_CNT) {
+            // every caller is still active, the least recently seen one gives way and starts over if it returns
+            auto lruIter = std::min_element(callers_.begin(), callers_.end(),
+                [](const auto& a, const auto& b) { return a.second.lastMs < b.second.lastMs; });
+            SOC_PERF_LOGW("rate limit caller table full, evict caller %{public}u", lruIter->first);
+            callers_.erase(lruIter);
+        }
+        iter = callers_.emplace(callerId, CallerState()).first;
+        iter->second.buckets.resize(classes_.size());
+        for (size_t i = 0; i < classes_.size(); i++) {
+            iter->second.buckets[i].milliTokens = (int64_t)classes_[i]->burst * MILLI_TOKENS_PER_TOKEN;
+            iter->second.buckets[i].refillMs = nowMs;
+        }
+    }
+    iter->second.lastMs = nowMs;
+    return iter->second;
+}
+
+bool SocPerfRateLimiter::TakeToken(CallerState& caller, int32_t classId, int64_t nowMs)
+{
+    TokenBucket& bucket = caller.buckets[classId];
+    const RateLimitClass& rateLimitClass = *classes_[classId];
+    int64_t capacity = (int64_t)rateLimitClass.burst * MILLI_TOKENS_PER_TOKEN;
+    // rate tokens per second is rate milli tokens per millisecond
+    bucket.milliTokens = std::min(capacity,
+        bucket.milliTokens + (nowMs - bucket.refillMs) * rateLimitClass.rate * MILLI_TOKENS_PER_TOKEN / MS_PER_SECOND);
+    bucket.refillMs = nowMs;
+    if (bucket.milliTokens < MILLI_TOKENS_PER_TOKEN) {
+        return false;
+    }
+    bucket.milliTokens -= MILLI_TOKENS_PER_TOKEN;
+    return true;
+}
+
+int64_t SocPerfRateLimiter::GetUsedBudget(CallerState& caller, int64_t nowMs)
+{
+    while (!caller.charges.empty() && caller.charges.front().first <= nowMs - windowMs_) {
+        caller.chargedMs -= caller.charges.front().second;
+        caller.charges.pop_front();
+    }
+    int64_t usedMs = caller.chargedMs;
+    for (auto iter = caller.holds.begin(); iter != caller.holds.end();) {
+        int64_t heldMs = GetHeldMs(iter->first, iter->second, nowMs);
+        auto cmdIter = cmds_.find(iter->first);
+        if (cmdIter != cmds_.end() && cmdIter->second.maxHoldMs > 0 && heldMs >= cmdIter->second.maxHoldMs) {
+            // the watchdog has dropped it, it ages out of the window like a finished hold
+            Charge(caller, heldMs, nowMs);
+            usedMs += heldMs;
+            iter = caller.holds.erase(iter);
+            continue;
+        }
+        usedMs += heldMs;
+        ++iter;
+    }
+    return usedMs;
+}
+
+int64_t SocPerfRateLimiter::GetHeldMs(int32_t cmdId, int64_t startMs, int64_t nowMs) const
+{
+    int64_t heldMs = nowMs - startMs;
+    auto iter = cmds_.find(cmdId);
+    if (iter != cmds_.end() && iter->second.maxHoldMs > 0) {
+        heldMs = std::min(heldMs, (int64_t)iter->second.maxHoldMs);
+    }
+    return heldMs;
+}
+
+void SocPerfRateLimiter::Charge(CallerState& caller, int64_t boostMs, int64_t nowMs)
+{
+    if (boostMs <= 0) {
+        return;
+    }
+    if (!caller.charges.empty() && nowMs - caller.charges.back().first < CHARGE_MERGE_MS) {
+        caller.charges.back().second += boostMs;
+    } else {
+        caller.charges.emplace_back(nowMs, boostMs);
+    }
+    caller.chargedMs += boostMs;
+}
+} // namespace SOCPERF
+} // namespace OHOS
@@ -14,6 +14,7 @@
  */
 
 #include "socperf_server.h"
+#include <algorithm>
 #include <file_ex.h>
 #include <string_ex.h>
 #include "ipc_skeleton.h"
@@ -30,6 +31,8 @@ constexpr int32_t HIVIEW_UID = 1201;
 const bool REGISTER_RESULT =
     SystemAbility::MakeAndRegisterAbility(DelayedSingleton<SocPerfServer>::GetInstance().get());
 const int32_t ENG_MODE = OHOS::system::GetIntParameter("const.debuggable", 0);
+constexpr size_t DUMP_RECORD_ARGS_SIZE = 2;
+constexpr size_t DUMP_RECORD_LINE_LEN = 128;
 
 SocPerfServer::SocPerfServer() : SystemAbility(SOC_PERF_SERVICE_SA_ID, true)
 {
@@ -45,6 +48,9 @@ void SocPerfServer::OnStart()
         SOC_PERF_LOGE("SocPerf Init FAILED");
         return;
     }
+    SocPerfConfig& config = SocPerfConfig::GetInstance();
+    rateLimiter_.Init(config.rateLimitClasses_, config.boostBudgetWindowMs_, config.boostBudgetMs_,
+        config.configPerfActionsInfo_[DEFAULT_CONFIG_MODE]);
     if (!Publish(DelayedSingleton<SocPerfServer>::GetInstance().get())) {
         SOC_PERF_LOGE("Register SystemAbility for SocPerf FAILED.");
         return;
@@ -82,50 +88,134 @@ int32_t SocPerfServer::Dump(int32_t fd, const std::vector<std::u16string>& args)
         return Str16ToStr8(arg);
     });
     std::string result;
-    result.append("usage: soc_perf service dump [<options>]\n")
-        .append("    1. PerfRequest(cmdId, msg)\n")
-        .append("    2. PerfRequestEx(cmdId, onOffTag, msg)\n")
-        .append("    3. LimitRequest(clientId, tags, configs, msg)\n")
-        .append("    -h: show the help.\n")
-        .append("    -a: show all info.\n");
+    if (argsInStr.size() == DUMP_RECORD_ARGS_SIZE && argsInStr[0] == "-r") {
+        result = DumpRecord(argsInStr[1]);
+    } else if (argsInStr.size() == 1 && argsInStr[0] == "-a") {
+        result = socPerf.GetStateInfo();
+        result.append(DumpClientHolds());
+        result.append(rateLimiter_.Dump());
+    } else if (argsInStr.size() == 1 && argsInStr[0] == "-l") {
+        result = socPerf.GetLatencyInfo();
+    } else if (argsInStr.size() == 1 && argsInStr[0] == "-q") {
+        result = socPerf.GetQueueInfo();
+    } else {
+        result.append("usage: soc_perf service dump [<options>]\n")
+            .append("    1. PerfRequest(cmdId, msg)\n")
+            .append("    2. PerfRequestEx(cmdId, onOffTag, msg)\n")
+            .append("    3. LimitRequest(clientId, tags, configs, msg)\n")
+            .append("    -h: show the help.\n")
+            .append("    -a: show a snapshot of resource status, limits and modes.\n")
+            .append("    -l: show request latency percentiles per entry and cmdId.\n")
+            .append("    -q: show socperf queue backlog, task run time and timer lag.\n")
+            .append("    -r start|stop|dump: record requests, dump prints the recording in hex.\n");
+    }
     if (!SaveStringToFd(fd, result)) {
         SOC_PERF_LOGE("Dump FAILED");
     }
     return ERR_OK;
 }
 
+std::string SocPerfServer::DumpRecord(const std::string& option)
+{
+    if (option == "start") {
+        socPerf.StartRecord();
+        return "request recording started\n";
+    }
+    if (option == "stop") {
+        socPerf.StopRecord();
+        return "request recording stopped\n";
+    }
+    if (option == "dump") {
+        std::string hex = socPerf.GetRecordHex();
+        std::string result;
+        for (size_t i = 0; i < hex.size(); i += DUMP_RECORD_LINE_LEN) {
+            result.append(hex, i, DUMP_RECORD_LINE_LEN).append("\n");
+        }
+        return result;
+    }
+    return "invalid record option, use start|stop|dump\n";
+}
+
+std::string SocPerfServer::DumpClientHolds()
+{
+    std::string result("client holds:\n");
+    std::lock_guard<std::mutex> lock(clientHoldsMutex_);
+    for (const auto& client : clientHolds_) {
+        result.append("    pid ").append(std::to_string(client.first))
+            .append(" token ").append(std::to_string(client.second.tokenId)).append(":");
+        for (const auto& hold : client.second.perfHolds) {
+            result.append(" ").append(std::to_string(hold.first));
+        }
+        for (const auto& owner : limitOwners_) {
+            if (owner.second == client.first) {
+                result.append(" limit ").append(std::to_string(owner.first.first))
+                    .append(":").append(std::to_string(owner.first.second));
+            }
+        }
+        result.append("\n");
+    }
+    return result;
+}
+
 ErrCode SocPerfServer::PerfRequest(int32_t cmdId, const std::string& msg)
 {
+    SocPerfAdmissionScope admissionScope;
     if (!HasPerfPermission()) {
         return ERR_PERMISSION_DENIED;
     }
+    if (!rateLimiter_.Acquire(IPCSkeleton::GetCallingTokenID(), cmdId)) {
+        return ERR_INVALID_OPERATION;
+    }
+    SocPerfCallingPidScope pidScope(IPCSkeleton::GetCallingPid());
     socPerf.PerfRequest(cmdId, msg);
     return ERR_OK;
 }
 
 ErrCode SocPerfServer::PerfRequestEx(int32_t cmdId, bool onOffTag, const std::string& msg)
 {
+    SocPerfAdmissionScope admissionScope;
     if (!HasPerfPermission()) {
         return ERR_PERMISSION_DENIED;
     }
-    socPerf.PerfRequestEx(cmdId, onOffTag, msg);
+    uint32_t tokenId = IPCSkeleton::GetCallingTokenID();
+    if (!onOffTag) {
+        // an off is never limited, it only ends the charged hold
+        rateLimiter_.Release(tokenId, cmdId);
+    } else if (!rateLimiter_.Acquire(tokenId, cmdId)) {
+        return ERR_INVALID_OPERATION;
+    }
+    int32_t callerPid = IPCSkeleton::GetCallingPid();
+    SocPerfCallingPidScope pidScope(callerPid);
+    int32_t matchCmdId = socPerf.PerfRequestEx(cmdId, onOffTag, msg, callerPid);
+    if (matchCmdId == INVALID_CMD_ID) {
+        return ERR_OK;
+    }
+    // only an on SocPerf took opens a hold, a rejected one leaves nothing to release
+    if (onOffTag) {
+        rateLimiter_.Hold(tokenId, cmdId);
+    }
+    RecordPerfHold(callerPid, cmdId, matchCmdId, onOffTag);
     return ERR_OK;
 }
 
 ErrCode SocPerfServer::PowerLimitBoost(bool onOffTag, const std::string& msg)
 {
+    SocPerfAdmissionScope admissionScope;
     if (!HasPerfPermission()) {
         return ERR_PERMISSION_DENIED;
     }
+    SocPerfCallingPidScope pidScope(IPCSkeleton::GetCallingPid());
     socPerf.PowerLimitBoost(onOffTag, msg);
     return ERR_OK;
 }
 
 ErrCode SocPerfServer::ThermalLimitBoost(bool onOffTag, const std::string& msg)
 {
+    SocPerfAdmissionScope admissionScope;
     if (!HasPerfPermission()) {
         return ERR_PERMISSION_DENIED;
     }
+    SocPerfCallingPidScope pidScope(IPCSkeleton::GetCallingPid());
     socPerf.ThermalLimitBoost(onOffTag, msg);
     return ERR_OK;
 }
@@ -133,35 +223,50 @@ ErrCode SocPerfServer::ThermalLimitBoost(bool onOffTag, const std::string& msg)
 ErrCode SocPerfServer::LimitRequest(int32_t clientId,
     const std::vector<int32_t>& tags, const std::vector<int64_t>& configs, const std::string& msg)
 {
+    SocPerfAdmissionScope admissionScope;
     if (!HasPerfPermission()) {
         return ERR_PERMISSION_DENIED;
     }
-    socPerf.LimitRequest(clientId, tags, configs, msg);
+    int32_t callerPid = IPCSkeleton::GetCallingPid();
+    SocPerfCallingPidScope pidScope(callerPid);
+    if (socPerf.LimitRequest(clientId, tags, configs, msg)) {
+        RecordLimitHold(callerPid, clientId, tags, configs);
+    }
     return ERR_OK;
 }
 
 ErrCode SocPerfServer::SetRequestStatus(bool status, const std::string &msg)
 {
+    SocPerfAdmissionScope admissionScope;
     if (!HasPerfPermission()) {
         return ERR_PERMISSION_DENIED;
     }
+    SocPerfCallingPidScope pidScope(IPCSkeleton::GetCallingPid());
     socPerf.SetRequestStatus(status, msg);
+    if (!status) {
+        ClearPerfHolds();
+        rateLimiter_.ReleaseAll();
+    }
     return ERR_OK;
 }
 
 ErrCode SocPerfServer::SetThermalLevel(int32_t level)
 {
+    SocPerfAdmissionScope admissionScope;
     if (!HasPerfPermission()) {
         return ERR_PERMISSION_DENIED;
     }
+    SocPerfCallingPidScope pidScope(IPCSkeleton::GetCallingPid());
     socPerf.SetThermalLevel(level);
     return ERR_OK;
 }
 ErrCode SocPerfServer::RequestDeviceMode(const std::string& mode, bool status)
 {
+    SocPerfAdmissionScope admissionScope;
     if (!HasPerfPermission()) {
         return ERR_PERMISSION_DENIED;
     }
+    SocPerfCallingPidScope pidScope(IPCSkeleton::GetCallingPid());
     socPerf.RequestDeviceMode(mode, status);
     return ERR_OK;
 }
@@ -180,6 +285,145 @@ ErrCode SocPerfServer::RequestCmdIdCount(const std::string& msg, std::string& fu
     return ERR_OK;
 }
 
+ErrCode SocPerfServer::RegisterClient(const sptr<IRemoteObject>& clientToken)
+{
+    if (!HasPerfPermission()) {
+        return ERR_PERMISSION_DENIED;
+    }
+    if (clientToken == nullptr) {
+        return ERR_INVALID_VALUE;
+    }
+    int32_t pid = IPCSkeleton::GetCallingPid();
+    sptr<IRemoteObject::DeathRecipient> recipient = new (std::nothrow) ClientDeathRecipient(*this, pid);
+    if (recipient == nullptr || !clientToken->AddDeathRecipient(recipient)) {
+        SOC_PERF_LOGE("RegisterClient of pid %{public}d FAILED", pid);
+        return ERR_INVALID_VALUE;
+    }
+    std::lock_guard<std::mutex> lock(clientHoldsMutex_);
+    ClientHolds& client = clientHolds_[pid];
+    if (client.clientToken != nullptr && client.recipient != nullptr) {
+        client.clientToken->RemoveDeathRecipient(client.recipient);
+    }
+    client.tokenId = IPCSkeleton::GetCallingTokenID();
+    client.clientToken = clientToken;
+    client.recipient = recipient;
+    SOC_PERF_LOGI("client pid %{public}d registered", pid);
+    return ERR_OK;
+}
+
+void SocPerfServer::RecordPerfHold(int32_t pid, int32_t cmdId, int32_t matchCmdId, bool onOffTag)
+{
+    std::lock_guard<std::mutex> lock(clientHoldsMutex_);
+    if (onOffTag) {
+        auto iter = clientHolds_.find(pid);
+        if (iter != clientHolds_.end()) {
+            iter->second.perfHolds[matchCmdId] = cmdId;
+        }
+        return;
+    }
+    // an off from any caller ends the one hold socperf keeps for the matched cmdId
+    for (auto& client : clientHolds_) {
+        client.second.perfHolds.erase(matchCmdId);
+    }
+}
+
+void SocPerfServer::RecordLimitHold(int32_t pid, int32_t clientId,
+    const std::vector<int32_t>& tags, const std::vector<int64_t>& configs)
+{
+    std::lock_guard<std::mutex> lock(clientHoldsMutex_);
+    bool registered = clientHolds_.find(pid) != clientHolds_.end();
+    for (size_t i = 0; i < tags.size() && i < configs.size(); i++) {
+        // a limit in level replaces one in value, both are released through the resId
+        int32_t resId = tags[i] > RES_ID_ADDITION ? tags[i] - RES_ID_ADDITION : tags[i];
+        // a value from anyone else takes the limit over, the previous owner no longer releases it
+        if (configs[i] == INVALID_VALUE || configs[i] == RESET_VALUE || !registered) {
+            limitOwners_.erase({clientId, resId});
+        } else {
+            limitOwners_[{clientId, resId}] = pid;
+        }
+    }
+}
+
+void SocPerfServer::ClearPerfHolds()
+{
+    std::lock_guard<std::mutex> lock(clientHoldsMutex_);
+    for (auto& client : clientHolds_) {
+        client.second.perfHolds.clear();
+    }
+}
+
+void SocPerfServer::ReleaseClientHolds(int32_t pid, const IRemoteObject::DeathRecipient* recipient)
+{
+    std::map<int32_t, int32_t> perfHolds;
+    std::vector<int32_t> orphanPerfHolds;
+    std::map<int32_t, std::vector<int32_t>> limitTags;
+    uint32_t tokenId = 0;
+    {
+        std::lock_guard<std::mutex> lock(clientHoldsMutex_);
+        auto iter = clientHolds_.find(pid);
+        if (iter == clientHolds_.end() || iter->second.recipient.GetRefPtr() != recipient) {
+            // the pid was taken over by a process that registered again
+            return;
+        }
+        orphanPerfHolds = GetOrphanPerfHolds(pid);
+        perfHolds.swap(iter->second.perfHolds);
+        tokenId = iter->second.tokenId;
+        clientHolds_.erase(iter);
+        for (auto ownerIter = limitOwners_.begin(); ownerIter != limitOwners_.end();) {
+            if (ownerIter->second != pid) {
+                ++ownerIter;
+                continue;
+            }
+            limitTags[ownerIter->first.first].push_back(ownerIter->first.second);
+            ownerIter = limitOwners_.erase(ownerIter);
+        }
+    }
+    SOC_PERF_LOGI("client pid %{public}d died, release %{public}zu of %{public}zu perf holds"
+        " and %{public}zu limit clients", pid, orphanPerfHolds.size(), perfHolds.size(), limitTags.size());
+    const std::string msg = "client died";
+    // the releases are recorded as calls of the dead client
+    SocPerfCallingPidScope pidScope(pid);
+    for (const auto& hold : perfHolds) {
+        rateLimiter_.Release(tokenId, hold.second);
+    }
+    // released on the cmdId the on was matched to, the device modes may have changed since
+    for (int32_t matchCmdId : orphanPerfHolds) {
+        socPerf.ReleasePerfRequestEx(matchCmdId, msg);
+    }
+    for (const auto& limit : limitTags) {
+        socPerf.LimitRequest(limit.first, limit.second, std::vector<int64_t>(limit.second.size(), INVALID_VALUE), msg);
+    }
+}
+
+std::vector<int32_t> SocPerfServer::GetOrphanPerfHolds(int32_t pid)
+{
+    // the hold of a matched cmdId is shared by every client that turned it on,
+    // it stays while another one still holds it
+    std::vector<int32_t> cmdIds;
+    auto iter = clientHolds_.find(pid);
+    if (iter == clientHolds_.end()) {
+        return cmdIds;
+    }
+    for (const auto& hold : iter->second.perfHolds) {
+        int32_t matchCmdId = hold.first;
+        bool shared = std::any_of(clientHolds_.begin(), clientHolds_.end(), [pid, matchCmdId](const auto& client) {
+            return client.first != pid && client.second.perfHolds.count(matchCmdId) != 0;
+        });
+        if (!shared) {
+            cmdIds.push_back(matchCmdId);
+        }
+    }
+    return cmdIds;
+}
+
+SocPerfServer::ClientDeathRecipient::ClientDeathRecipient(SocPerfServer& socPerfServer, int32_t pid)
+    : socPerfServer_(socPerfServer), pid_(pid) {}
+
+void SocPerfServer::ClientDeathRecipient::OnRemoteDied(const wptr<IRemoteObject>& object)
+{
+    socPerfServer_.ReleaseClientHolds(pid_, this);
+}
+
 const std::string NEEDED_PERMISSION = "ohos.permission.REPORT_RESOURCE_SCHEDULE_EVENT";
 
 bool SocPerfServer::HasPerfPermission()
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOC_PERF_TEST_BENCHMARK_MOCK_CONFIG_POLICY_UTILS_H
+#define SOC_PERF_TEST_BENCHMARK_MOCK_CONFIG_POLICY_UTILS_H
+
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define MAX_CFG_POLICY_DIRS_CNT 32
+
+// the benchmark fills SocPerfConfig directly, the replay tool points SOCPERF_CONFIG_DIR at a config root laid out like /system
+struct CfgFiles {
+    char* paths[MAX_CFG_POLICY_DIRS_CNT];
+};
+
+inline char* GetOneCfgFile(const char* pathSuffix, char* buf, unsigned int bufLength)
+{
+    const char* dir = getenv("SOCPERF_CONFIG_DIR");
+    if (dir == nullptr || buf == nullptr ||
+        snprintf(buf, bufLength, "%s/%s", dir, pathSuffix) >= static_cast<int>(bufLength)) {
+        return nullptr;
+    }
+    char realPath[PATH_MAX + 1] = {0};
+    return realpath(buf, realPath) == nullptr ? nullptr : buf;
+}
+
+inline CfgFiles* GetCfgFiles(const char* pathSuffix)
+{
+    char buf[PATH_MAX + 1];
+    if (GetOneCfgFile(pathSuffix, buf, sizeof(buf)) == nullptr) {
+        return nullptr;
+    }
+    CfgFiles* res = static_cast<CfgFiles*>(calloc(1, sizeof(CfgFiles)));
+    if (res != nullptr) {
+        res->paths[0] = strdup(buf);
+    }
+    return res;
+}
+
+inline void FreeCfgFiles(CfgFiles* res)
+{
+    if (res == nullptr) {
+        return;
+    }
+    for (char* path : res->paths) {
+        free(path);
+    }
+    free(res);
+}
+
+#endif // SOC_PERF_TEST_BENCHMARK_MOCK_CONFIG_POLICY_UTILS_H
@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOC_PERF_TEST_BENCHMARK_MOCK_FFRT_H
+#define SOC_PERF_TEST_BENCHMARK_MOCK_FFRT_H
+
+#include <atomic>
+#include <chrono>
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "socperf_clock.h"
+
+typedef enum {
+    ffrt_queue_priority_immediate = 0,
+    ffrt_queue_priority_high,
+    ffrt_queue_priority_low,
+    ffrt_queue_priority_idle,
+} ffrt_queue_priority_t;
+
+// in-process stand-in for an ffrt queue with a single worker: due tasks run one by one, the highest priority
+// first and in due time order within a priority. Due times follow SocPerfClock, under virtual time nothing
+// fires until advance_to() moves the clock.
+namespace ffrt {
+enum queue_type {
+    queue_serial = 0,
+    queue_concurrent,
+    queue_max,
+};
+
+enum qos_default {
+    qos_inherit = -1,
+    qos_background,
+    qos_utility,
+    qos_default,
+    qos_user_initiated,
+    qos_deadline_request,
+    qos_user_interactive,
+};
+
+class queue_attr {
+public:
+    queue_attr& qos(int32_t qos)
+    {
+        qos_ = qos;
+        return *this;
+    }
+
+    queue_attr& max_concurrency(int32_t)
+    {
+        return *this;
+    }
+
+private:
+    int32_t qos_ = qos_default;
+};
+
+class task_attr {
+public:
+    task_attr& delay(uint64_t delayUs)
+    {
+        delay_ = delayUs;
+        return *this;
+    }
+
+    uint64_t delay() const
+    {
+        return delay_;
+    }
+
+    task_attr& name(const char*)
+    {
+        return *this;
+    }
+
+    task_attr& priority(ffrt_queue_priority_t prio)
+    {
+        priority_ = prio;
+        return *this;
+    }
+
+    ffrt_queue_priority_t priority() const
+    {
+        return priority_;
+    }
+
+private:
+    uint64_t delay_ = 0;
+    ffrt_queue_priority_t priority_ = ffrt_queue_priority_low;
+};
+
+struct task_node {
+    std::function<void()> func;
+    ffrt_queue_priority_t priority = ffrt_queue_priority_low;
+    bool finished = false;
+    bool canceled = false;
+};
+
+class task_handle {
+public:
+    task_handle() = default;
+    task_handle(std::nullptr_t) {}
+    explicit task_handle(std::shared_ptr<task_node> node) : node_(std::move(node)) {}
+
+    bool operator==(std::nullptr_t) const
+    {
+        return node_ == nullptr;
+    }
+
+    bool operator!=(std::nullptr_t) const
+    {
+        return node_ != nullptr;
+    }
+
+    explicit operator bool() const
+    {
+        return node_ != nullptr;
+    }
+
+    std::shared_ptr<task_node> node_;
+};
+
+class queue {
+public:
+    explicit queue(const char*, const queue_attr& = {}) : worker_([this] { Run(); }) {}
+    queue(queue_type, const char*, const queue_attr& = {}) : worker_([this] { Run(); }) {}
+
+    ~queue()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cond_.notify_all();
+        worker_.join();
+    }
+
+    void submit(const std::function<void()>& func, const task_attr& attr = {})
+    {
+        submit_h(func, attr);
+    }
+
+    task_handle submit_h(const std::function<void()>& func, const task_attr& attr = {})
+    {
+        auto node = std::make_shared<task_node>();
+        node->func = func;
+        node->priority = attr.priority();
+        int64_t due = Clock().NowUs() + static_cast<int64_t>(attr.delay());
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.emplace(std::make_pair(due, seq_++), node);
+        }
+        cond_.notify_all();
+        return task_handle(node);
+    }
+
+    int cancel(const task_handle& handle)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto iter = tasks_.begin(); iter != tasks_.end(); ++iter) {
+            if (iter->second == handle.node_) {
+                handle.node_->canceled = true;
+                tasks_.erase(iter);
+                cond_.notify_all();
+                return 0;
+            }
+        }
+        for (auto& ready : ready_) {
+            for (auto iter = ready.begin(); iter != ready.end(); ++iter) {
+                if (*iter == handle.node_) {
+                    handle.node_->canceled = true;
+                    ready.erase(iter);
+                    cond_.notify_all();
+                    return 0;
+                }
+            }
+        }
+        return -1;
+    }
+
+    void wait(const task_handle& handle)
+    {
+        if (handle.node_ == nullptr) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [&handle] { return handle.node_->finished || handle.node_->canceled; });
+    }
+
+    // virtual time only: moves the clock to nowUs, running every task due on the way in due time order
+    void advance_to(int64_t nowUs)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        // the clock is shared, another queue may have moved it while this worker was asleep
+        cond_.notify_all();
+        while (true) {
+            cond_.wait(lock, [this] {
+                return !running_ && !HasReady() && (tasks_.empty() || !IsDue(tasks_.begin()->first));
+            });
+            if (tasks_.empty() || tasks_.begin()->first.first > nowUs) {
+                break;
+            }
+            Clock().AdvanceTo(tasks_.begin()->first.first);
+            cond_.notify_all();
+        }
+        Clock().AdvanceTo(nowUs);
+    }
+
+private:
+    using TaskKey = std::pair<int64_t, uint64_t>;
+
+    static OHOS::SOCPERF::SocPerfClock& Clock()
+    {
+        return OHOS::SOCPERF::SocPerfClock::GetInstance();
+    }
+
+    static bool IsDue(const TaskKey& key)
+    {
+        return key.first <= Clock().NowUs();
+    }
+
+    bool HasReady() const
+    {
+        for (const auto& ready : ready_) {
+            if (!ready.empty()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void Run()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_) {
+            // due tasks leave the timeline in due time order and wait in the lane of their priority
+            while (!tasks_.empty() && IsDue(tasks_.begin()->first)) {
+                std::shared_ptr<task_node> due = tasks_.begin()->second;
+                ready_[due->priority].push_back(due);
+                tasks_.erase(tasks_.begin());
+            }
+            std::shared_ptr<task_node> node = nullptr;
+            for (auto& ready : ready_) {
+                if (!ready.empty()) {
+                    node = ready.front();
+                    ready.pop_front();
+                    break;
+                }
+            }
+            if (node == nullptr) {
+                if (tasks_.empty() || Clock().IsVirtualTime()) {
+                    cond_.wait(lock);
+                } else {
+                    cond_.wait_for(lock, std::chrono::microseconds(tasks_.begin()->first.first - Clock().NowUs()));
+                }
+                continue;
+            }
+            running_ = true;
+            lock.unlock();
+            node->func();
+            lock.lock();
+            running_ = false;
+            node->finished = true;
+            cond_.notify_all();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::map<TaskKey, std::shared_ptr<task_node>> tasks_;
+    std::array<std::deque<std::shared_ptr<task_node>>, ffrt_queue_priority_idle + 1> ready_;
+    uint64_t seq_ = 0;
+    bool running_ = false;
+    bool stop_ = false;
+    std::thread worker_;
+};
+} // namespace ffrt
+
+#endif // SOC_PERF_TEST_BENCHMARK_MOCK_FFRT_H
@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOC_PERF_TEST_BENCHMARK_MOCK_HITRACE_METER_H
+#define SOC_PERF_TEST_BENCHMARK_MOCK_HITRACE_METER_H
+
+#include <cstdint>
+
+constexpr uint64_t HITRACE_TAG_OHOS = 1ULL << 30;
+constexpr uint64_t HITRACE_TAG_APP = 1ULL << 62;
+
+enum HiTraceOutputLevel {
+    HITRACE_LEVEL_DEBUG = 0,
+    HITRACE_LEVEL_INFO = 1,
+};
+
+inline void StartTraceEx(HiTraceOutputLevel level, uint64_t tag, const char* name, const char* customArgs = "") {}
+inline void FinishTraceEx(HiTraceOutputLevel level, uint64_t tag) {}
+inline void CountTraceEx(HiTraceOutputLevel level, uint64_t tag, const char* name, int64_t count) {}
+
+#endif // SOC_PERF_TEST_BENCHMARK_MOCK_HITRACE_METER_H
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOC_PERF_TEST_BENCHMARK_MOCK_HITRACECHAINC_H
+#define SOC_PERF_TEST_BENCHMARK_MOCK_HITRACECHAINC_H
+
+#include <cstdint>
+
+struct HiTraceIdStruct {
+    uint64_t valid : 1;
+    uint64_t chainId : 60;
+};
+
+enum HiTraceFlag {
+    HITRACE_FLAG_DEFAULT = 0,
+    HITRACE_FLAG_INCLUDE_ASYNC = 1 << 0,
+    HITRACE_FLAG_DONOT_CREATE_SPAN = 1 << 1,
+    HITRACE_FLAG_NO_BE_INFO = 1 << 3,
+};
+
+inline HiTraceIdStruct HiTraceChainGetId()
+{
+    return {0, 0};
+}
+
+inline int HiTraceChainIsValid(const HiTraceIdStruct* id)
+{
+    return id != nullptr && id->valid;
+}
+
+inline HiTraceIdStruct HiTraceChainBegin(const char* name, int flags)
+{
+    return {1, 1};
+}
+
+inline void HiTraceChainEnd(const HiTraceIdStruct* id) {}
+
+#endif // SOC_PERF_TEST_BENCHMARK_MOCK_HITRACECHAINC_H
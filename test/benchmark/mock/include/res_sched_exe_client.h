@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOC_PERF_TEST_BENCHMARK_MOCK_RES_SCHED_EXE_CLIENT_H
+#define SOC_PERF_TEST_BENCHMARK_MOCK_RES_SCHED_EXE_CLIENT_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace nlohmann {
+// only the assignments socperf makes to the payload are needed
+class json {
+public:
+    json& operator[](const std::string& key)
+    {
+        return fields_[key];
+    }
+
+    template<typename T>
+    json& operator=(const std::vector<T>& value)
+    {
+        values_.assign(value.begin(), value.end());
+        return *this;
+    }
+
+    const std::vector<int64_t>& Get(const std::string& key) const
+    {
+        static const std::vector<int64_t> empty;
+        auto iter = fields_.find(key);
+        return iter == fields_.end() ? empty : iter->second.values_;
+    }
+
+private:
+    std::map<std::string, json> fields_;
+    std::vector<int64_t> values_;
+};
+} // namespace nlohmann
+
+namespace OHOS {
+namespace ResourceSchedule {
+class ResSchedExeClient {
+public:
+    using RequestHook = std::function<void(uint32_t, int64_t, const nlohmann::json&)>;
+
+    static ResSchedExeClient& GetInstance()
+    {
+        static ResSchedExeClient instance;
+        return instance;
+    }
+
+    void SendRequestAsync(uint32_t resType, int64_t value, const nlohmann::json& payload)
+    {
+        requestCount_++;
+        if (hook_) {
+            hook_(resType, value, payload);
+        }
+    }
+
+    std::atomic<uint64_t> requestCount_ {0};
+    // set before the queue starts, lets host tools observe the nodes written through rss exe
+    RequestHook hook_;
+};
+} // namespace ResourceSchedule
+} // namespace OHOS
+
+#endif // SOC_PERF_TEST_BENCHMARK_MOCK_RES_SCHED_EXE_CLIENT_H
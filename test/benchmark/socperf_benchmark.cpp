@@ -0,0 +1,337 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#define private public
+#include "socperf.h"
+#undef private
+#include "socperf_clock.h"
+
+namespace OHOS {
+namespace SOCPERF {
+namespace {
+    const int32_t BENCH_CMD_ID_BEGIN = 20000;
+    const int32_t BENCH_HOLD_CMD_ID_BEGIN = 40000;
+    const int32_t BENCH_RES_PER_CMD = 4;
+    const int32_t BENCH_AVAILABLE_CNT = 16;
+    const int64_t BENCH_AVAILABLE_BEGIN = 300000;
+    const int64_t BENCH_AVAILABLE_STEP = 100000;
+    const int32_t BENCH_BOOST_DURATION_MS = 2000;
+    const int32_t BENCH_EXPIRY_DURATION_MS = 1;
+    const int32_t BENCH_LIMIT_CLIENT_ID = ACTION_TYPE_POWER;
+    const int32_t BENCH_LIMIT_BATCH_SIZE = 10;
+    const int32_t DEFAULT_ITERATIONS = 2000;
+    const int32_t QUICK_ITERATIONS = 50;
+    const int32_t EXPIRY_ITERATION_DIVISOR = 10;
+    const int32_t SOAK_SECONDS = 3600;
+    const int32_t QUICK_SOAK_SECONDS = 60;
+    const int64_t SOAK_REQUEST_INTERVAL_US = 50000;
+    const int64_t US_PER_SECOND = 1000000;
+    const double NS_PER_US = 1000.0;
+    const int64_t NS_PER_MS = 1000000;
+    const double US_PER_S = 1000000.0;
+    const double PERCENTILE_50 = 0.5;
+    const double PERCENTILE_99 = 0.99;
+    const std::vector<int32_t> CONFIG_SIZES = { 10, 100, 1000 };
+    const std::vector<int32_t> HOLD_COUNTS = { 0, 16, 256 };
+    const int32_t BENCH_WORKER_CNT = 4;
+
+    std::atomic<uint64_t> g_reportCount {0};
+    std::atomic<int64_t> g_lastReportNs {0};
+
+    int64_t NowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    int ReportDataBench(const std::vector<int32_t>&, const std::vector<int64_t>&,
+        const std::vector<int64_t>&, const std::string&)
+    {
+        g_lastReportNs = NowNs();
+        g_reportCount++;
+        return 0;
+    }
+}
+
+class SocPerfBenchmark {
+public:
+    SocPerfBenchmark(int32_t resCnt, int32_t holdCnt, int32_t workerCnt = 1)
+        : resCnt_(resCnt), holdCnt_(holdCnt), workerCnt_(workerCnt)
+    {
+        InitConfig();
+        socPerf_ = std::make_unique<SocPerf>();
+        socPerf_->Init();
+        Flush();
+        for (int32_t i = 0; i < holdCnt_; i++) {
+            socPerf_->PerfRequestEx(BENCH_HOLD_CMD_ID_BEGIN + i, true, "");
+        }
+        Flush();
+    }
+
+    ~SocPerfBenchmark()
+    {
+        socPerf_ = nullptr;
+        SocPerfConfig& config = SocPerfConfig::GetInstance();
+        config.resourceNodeInfo_.clear();
+        config.configPerfActionsInfo_.clear();
+        config.workerCnt_ = 1;
+        config.BuildConstraintDomains();
+    }
+
+    void RunPerfRequestLatency(int32_t iterations)
+    {
+        std::vector<double> samples;
+        for (int32_t i = 0; i < iterations; i++) {
+            int32_t cmdId = BENCH_CMD_ID_BEGIN + i % resCnt_;
+            samples.push_back(MeasureUs([this, cmdId] { socPerf_->PerfRequest(cmdId, ""); }));
+        }
+        PrintLatency("perf_request", samples);
+    }
+
+    void RunExpiryLatency(int32_t iterations)
+    {
+        std::vector<double> samples;
+        for (int32_t i = 0; i < iterations; i++) {
+            int32_t cmdId = BENCH_CMD_ID_BEGIN + resCnt_ + i % resCnt_;
+            socPerf_->boostTime_.clear();
+            int64_t dueNs = NowNs() + BENCH_EXPIRY_DURATION_MS * NS_PER_MS;
+            socPerf_->PerfRequest(cmdId, "");
+            Flush();
+            uint64_t reportCount = g_reportCount;
+            std::this_thread::sleep_for(std::chrono::milliseconds(BENCH_EXPIRY_DURATION_MS * 2));
+            Flush();
+            if (g_reportCount != reportCount) {
+                // time from the due point to the reset reaching the backend, queue wakeup included
+                samples.push_back(std::max<int64_t>(g_lastReportNs - dueNs, 0) / NS_PER_US);
+            }
+        }
+        PrintLatency("expiry", samples);
+    }
+
+    void RunLimitRequestLatency(int32_t iterations)
+    {
+        std::vector<double> samples;
+        for (int32_t i = 0; i < iterations; i++) {
+            int32_t resId = MIN_RESOURCE_ID + i % resCnt_;
+            int64_t value = BENCH_AVAILABLE_BEGIN + (i % BENCH_AVAILABLE_CNT) * BENCH_AVAILABLE_STEP;
+            samples.push_back(MeasureUs([this, resId, value] {
+                socPerf_->LimitRequest(BENCH_LIMIT_CLIENT_ID, { resId }, { value }, "");
+            }));
+        }
+        PrintLatency("limit_request", samples);
+    }
+
+    // a thermal client setting several tags at once
+    void RunLimitBatchLatency(int32_t iterations)
+    {
+        std::vector<double> samples;
+        for (int32_t i = 0; i < iterations; i++) {
+            std::vector<int32_t> tags;
+            std::vector<int64_t> configs;
+            for (int32_t j = 0; j < BENCH_LIMIT_BATCH_SIZE && j < resCnt_; j++) {
+                tags.push_back(MIN_RESOURCE_ID + (i + j) % resCnt_);
+                configs.push_back(BENCH_AVAILABLE_BEGIN + ((i + j) % BENCH_AVAILABLE_CNT) * BENCH_AVAILABLE_STEP);
+            }
+            samples.push_back(MeasureUs([this, &tags, &configs] {
+                socPerf_->LimitRequest(BENCH_LIMIT_CLIENT_ID, tags, configs, "");
+            }));
+        }
+        PrintLatency("limit_batch", samples);
+    }
+
+    void RunThroughput(int32_t iterations)
+    {
+        int64_t beginNs = NowNs();
+        for (int32_t i = 0; i < iterations; i++) {
+            socPerf_->boostTime_.clear();
+            socPerf_->PerfRequest(BENCH_CMD_ID_BEGIN + i % resCnt_, "");
+        }
+        Flush();
+        double elapsedUs = (NowNs() - beginNs) / NS_PER_US;
+        printf("%-16s %8d %6d %8d %12.0f req/s\n", "throughput", resCnt_, holdCnt_, iterations,
+            elapsedUs > 0 ? iterations * US_PER_S / elapsedUs : 0);
+    }
+
+    // boost traffic under virtual time, every expiry runs through the queue without sleeping
+    void RunVirtualSoak(int32_t simulatedSeconds)
+    {
+        SocPerfClock& clock = SocPerfClock::GetInstance();
+        Flush();
+        clock.EnableVirtualTime(clock.NowUs());
+        int64_t endUs = clock.NowUs() + simulatedSeconds * US_PER_SECOND;
+        uint64_t reportCount = g_reportCount;
+        int64_t beginNs = NowNs();
+        int32_t requests = 0;
+        for (int64_t nowUs = clock.NowUs(); nowUs < endUs; nowUs += SOAK_REQUEST_INTERVAL_US) {
+            AdvanceTo(nowUs);
+            int32_t index = requests % resCnt_;
+            socPerf_->PerfRequest(BENCH_CMD_ID_BEGIN + (requests % RES_ID_AND_VALUE_PAIR) * resCnt_ + index, "");
+            requests++;
+        }
+        AdvanceTo(endUs);
+        double elapsedS = (NowNs() - beginNs) / NS_PER_US / US_PER_S;
+        clock.DisableVirtualTime();
+        printf("%-16s %8d %6d %8d %12.0f sim_s/s %llu reports\n", "virtual_soak", resCnt_, holdCnt_, requests,
+            elapsedS > 0 ? simulatedSeconds / elapsedS : 0, static_cast<unsigned long long>(g_reportCount - reportCount));
+    }
+
+private:
+    void InitConfig()
+    {
+        SocPerfConfig& config = SocPerfConfig::GetInstance();
+        config.resourceNodeInfo_.clear();
+        config.configPerfActionsInfo_.clear();
+        config.reportFunc_ = ReportDataBench;
+        for (int32_t i = 0; i < resCnt_; i++) {
+            int32_t resId = MIN_RESOURCE_ID + i;
+            bool isMax = i % RES_ID_AND_VALUE_PAIR == 1;
+            int32_t pair = isMax ? resId - 1 : (i + 1 < resCnt_ ? resId + 1 : INVALID_VALUE);
+            auto resNode = std::make_shared<ResNode>(resId, "bench_res_" + std::to_string(i),
+                isMax ? MAX_FREQUE_NODE : 0, pair, REPORT_TO_PERFSO);
+            for (int32_t j = 0; j < BENCH_AVAILABLE_CNT; j++) {
+                resNode->AddAvailable(BENCH_AVAILABLE_BEGIN + j * BENCH_AVAILABLE_STEP);
+            }
+            resNode->def = resNode->available.front();
+            config.resourceNodeInfo_[resId] = resNode;
+        }
+        auto& actionsInfo = config.configPerfActionsInfo_[DEFAULT_CONFIG_MODE];
+        for (int32_t i = 0; i < resCnt_; i++) {
+            AddActions(actionsInfo, BENCH_CMD_ID_BEGIN + i, i, BENCH_BOOST_DURATION_MS);
+            AddActions(actionsInfo, BENCH_CMD_ID_BEGIN + resCnt_ + i, i, BENCH_EXPIRY_DURATION_MS);
+        }
+        for (int32_t i = 0; i < holdCnt_; i++) {
+            AddActions(actionsInfo, BENCH_HOLD_CMD_ID_BEGIN + i, i, 0);
+        }
+        config.workerCnt_ = workerCnt_;
+        config.BuildConstraintDomains();
+    }
+
+    void AddActions(std::unordered_map<int32_t, std::shared_ptr<Actions>>& actionsInfo,
+        int32_t cmdId, int32_t index, int32_t duration)
+    {
+        auto actions = std::make_shared<Actions>(cmdId, "bench_cmd_" + std::to_string(cmdId));
+        auto action = std::make_shared<Action>();
+        action->duration = duration;
+        for (int32_t j = 0; j < BENCH_RES_PER_CMD; j++) {
+            action->variable.push_back(MIN_RESOURCE_ID + (index + j) % resCnt_);
+            action->variable.push_back(BENCH_AVAILABLE_BEGIN +
+                ((index + j + cmdId) % BENCH_AVAILABLE_CNT) * BENCH_AVAILABLE_STEP);
+        }
+        actions->actionList.push_back(action);
+        actionsInfo[cmdId] = actions;
+    }
+
+    // waits until every task submitted so far has run on the worker queues
+    void Flush()
+    {
+        // the other workers post their boost status to the primary, so it goes last
+        for (auto it = socPerf_->socperfThreadWraps_.rbegin(); it != socPerf_->socperfThreadWraps_.rend(); ++it) {
+            ffrt::queue& queue = (*it)->socperfQueue_;
+            queue.wait(queue.submit_h([] {}));
+        }
+    }
+
+    void AdvanceTo(int64_t nowUs)
+    {
+        for (auto it = socPerf_->socperfThreadWraps_.rbegin(); it != socPerf_->socperfThreadWraps_.rend(); ++it) {
+            (*it)->socperfQueue_.advance_to(nowUs);
+        }
+    }
+
+    template<typename Func>
+    double MeasureUs(Func func)
+    {
+        // the 8ms debounce of the same cmdId would turn most samples into no-ops
+        socPerf_->boostTime_.clear();
+        uint64_t reportCount = g_reportCount;
+        int64_t beginNs = NowNs();
+        func();
+        Flush();
+        int64_t endNs = g_reportCount != reportCount ? g_lastReportNs.load() : NowNs();
+        return (endNs - beginNs) / NS_PER_US;
+    }
+
+    void PrintLatency(const char* name, std::vector<double>& samples)
+    {
+        if (samples.empty()) {
+            printf("%-16s %8d %6d %8d %12s\n", name, resCnt_, holdCnt_, 0, "-");
+            return;
+        }
+        std::sort(samples.begin(), samples.end());
+        double sum = 0;
+        for (double sample : samples) {
+            sum += sample;
+        }
+        size_t size = samples.size();
+        printf("%-16s %8d %6d %8zu %12.2f %10.2f %10.2f %10.2f\n", name, resCnt_, holdCnt_, size, sum / size,
+            samples[(size_t)(size * PERCENTILE_50)], samples[std::min((size_t)(size * PERCENTILE_99), size - 1)],
+            samples.back());
+    }
+
+    int32_t resCnt_;
+    int32_t holdCnt_;
+    int32_t workerCnt_;
+    std::unique_ptr<SocPerf> socPerf_;
+};
+} // namespace SOCPERF
+} // namespace OHOS
+
+int main(int argc, char* argv[])
+{
+    using namespace OHOS::SOCPERF;
+    int32_t iterations = DEFAULT_ITERATIONS;
+    int32_t soakSeconds = SOAK_SECONDS;
+    if (argc > 1 && strcmp(argv[1], "--quick") == 0) {
+        iterations = QUICK_ITERATIONS;
+        soakSeconds = QUICK_SOAK_SECONDS;
+    }
+    printf("%-16s %8s %6s %8s %12s %10s %10s %10s\n", "bench", "res", "holds", "samples", "mean_us", "p50_us",
+        "p99_us", "max_us");
+    for (int32_t resCnt : CONFIG_SIZES) {
+        for (int32_t holdCnt : HOLD_COUNTS) {
+            if (holdCnt > resCnt) {
+                continue;
+            }
+            SocPerfBenchmark benchmark(resCnt, holdCnt);
+            benchmark.RunPerfRequestLatency(iterations);
+            benchmark.RunExpiryLatency(iterations / EXPIRY_ITERATION_DIVISOR + 1);
+            benchmark.RunLimitRequestLatency(iterations);
+            benchmark.RunLimitBatchLatency(iterations);
+            benchmark.RunThroughput(iterations);
+            benchmark.RunVirtualSoak(soakSeconds);
+        }
+    }
+    printf("# %d workers\n", BENCH_WORKER_CNT);
+    SocPerfBenchmark benchmark(CONFIG_SIZES.back(), 0, BENCH_WORKER_CNT);
+    benchmark.RunPerfRequestLatency(iterations);
+    benchmark.RunThroughput(iterations);
+    benchmark.RunVirtualSoak(soakSeconds);
+    return 0;
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <list>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#define private public
+#include "socperf.h"
+#undef private
+#include "res_sched_exe_client.h"
+#include "socperf_clock.h"
+
+namespace OHOS {
+namespace SOCPERF {
+namespace {
+    const char RECORD_MAGIC[] = "SPRC";
+    const size_t RECORD_MAGIC_LEN = 4;
+    const int64_t US_PER_MS = 1000;
+
+    int64_t g_replayBeginUs = 0;
+
+    void PrintTimeline(const char* backend, const std::vector<int64_t>& resId, const std::vector<int64_t>& value,
+        const std::vector<int64_t>& endTime)
+    {
+        SocPerfClock& clock = SocPerfClock::GetInstance();
+        int64_t nowUs = clock.NowUs() - g_replayBeginUs;
+        int64_t wallNowMs = clock.ToWallTimeMs(clock.NowMs());
+        for (size_t i = 0; i < resId.size() && i < value.size(); i++) {
+            std::string remainMs = i >= endTime.size() ? "-" :
+                (endTime[i] == MAX_INT_VALUE ? "hold" : std::to_string(endTime[i] - wallNowMs));
+            printf("%10lld %-6s %6lld %12lld %8s\n", static_cast<long long>(nowUs), backend,
+                static_cast<long long>(resId[i]), static_cast<long long>(value[i]), remainMs.c_str());
+        }
+    }
+
+    int ReportDataReplay(const std::vector<int32_t>& resId, const std::vector<int64_t>& value,
+        const std::vector<int64_t>& endTime, const std::string&)
+    {
+        PrintTimeline("perfso", std::vector<int64_t>(resId.begin(), resId.end()), value, endTime);
+        return 0;
+    }
+
+    void ReportRssExeReplay(uint32_t, int64_t, const nlohmann::json& payload)
+    {
+        PrintTimeline("node", payload.Get(QOSID_STRING), payload.Get(VALUE_STRING), {});
+    }
+
+    bool LoadRecording(const char* path, std::vector<SocPerfRecord>& records)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            fprintf(stderr, "failed to open %s\n", path);
+            return false;
+        }
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (data.size() < RECORD_MAGIC_LEN || memcmp(data.data(), RECORD_MAGIC, RECORD_MAGIC_LEN) != 0) {
+            // the hex text printed by "hidumper -s 1906 -a '-r dump'"
+            std::vector<uint8_t> binary;
+            if (!SocPerfRecorder::FromHex(std::string(data.begin(), data.end()), binary)) {
+                fprintf(stderr, "%s is neither a recording nor its hex dump\n", path);
+                return false;
+            }
+            data.swap(binary);
+        }
+        if (!SocPerfRecorder::Parse(data, records)) {
+            fprintf(stderr, "%s is a truncated or unsupported recording\n", path);
+            return false;
+        }
+        return true;
+    }
+
+    void Dispatch(SocPerf& socPerf, const SocPerfRecord& record)
+    {
+        switch (record.entry) {
+            case RECORD_ENTRY_PERF_REQUEST:
+                socPerf.PerfRequest(record.id, "");
+                break;
+            case RECORD_ENTRY_PERF_REQUEST_EX:
+                socPerf.PerfRequestEx(record.id, record.onOff, "");
+                break;
+            case RECORD_ENTRY_POWER_LIMIT_BOOST:
+                socPerf.PowerLimitBoost(record.onOff, record.str);
+                break;
+            case RECORD_ENTRY_THERMAL_LIMIT_BOOST:
+                socPerf.ThermalLimitBoost(record.onOff, "");
+                break;
+            case RECORD_ENTRY_LIMIT_REQUEST:
+                socPerf.LimitRequest(record.id, record.tags, record.configs, "");
+                break;
+            case RECORD_ENTRY_SET_REQUEST_STATUS:
+                socPerf.SetRequestStatus(record.onOff, "");
+                break;
+            case RECORD_ENTRY_SET_THERMAL_LEVEL:
+                socPerf.SetThermalLevel(record.id);
+                break;
+            case RECORD_ENTRY_REQUEST_DEVICE_MODE:
+                socPerf.RequestDeviceMode(record.str, record.onOff);
+                break;
+            default:
+                fprintf(stderr, "skip unknown record entry %u\n", record.entry);
+                break;
+        }
+    }
+
+    void AdvanceTo(SocPerf& socPerf, int64_t nowUs)
+    {
+        // the other workers post their boost status to the primary, so it goes last
+        for (auto it = socPerf.socperfThreadWraps_.rbegin(); it != socPerf.socperfThreadWraps_.rend(); ++it) {
+            (*it)->socperfQueue_.advance_to(nowUs);
+        }
+    }
+}
+} // namespace SOCPERF
+} // namespace OHOS
+
+/*
+ * Feeds a recording taken with "hidumper -s 1906 -a '-r start|stop|dump'" back into SocPerf under virtual
+ * time and prints every value that reaches a backend as: t_us backend resId value remain_ms
+ *   SOCPERF_CONFIG_DIR=<root holding the etc/soc_perf xml files> socperf_replay <recording> [tail_ms]
+ */
+int main(int argc, char* argv[])
+{
+    using namespace OHOS::SOCPERF;
+    if (argc < 2) {
+        fprintf(stderr, "usage: SOCPERF_CONFIG_DIR=<config root> %s <recording> [tail_ms]\n", argv[0]);
+        return 1;
+    }
+    std::vector<SocPerfRecord> records;
+    if (!LoadRecording(argv[1], records)) {
+        return 1;
+    }
+    int64_t tailUs = (argc > 2 ? atoll(argv[2]) : 0) * US_PER_MS;
+    // recorded gaps are kept exactly and boosts expire without sleeping, however long the recording is
+    g_replayBeginUs = records.empty() ? 0 : records.front().timestampUs;
+    SocPerfClock::GetInstance().EnableVirtualTime(g_replayBeginUs);
+    SocPerfConfig::GetInstance().reportFunc_ = ReportDataReplay;
+    OHOS::ResourceSchedule::ResSchedExeClient::GetInstance().hook_ = ReportRssExeReplay;
+    SocPerf socPerf;
+    if (!socPerf.Init()) {
+        fprintf(stderr, "failed to load the configs, check SOCPERF_CONFIG_DIR\n");
+        return 1;
+    }
+    for (const SocPerfRecord& record : records) {
+        AdvanceTo(socPerf, record.timestampUs);
+        Dispatch(socPerf, record);
+    }
+    AdvanceTo(socPerf, SocPerfClock::GetInstance().NowUs() + tailUs);
+    printf("replayed %zu records\n", records.size());
+    return 0;
+}
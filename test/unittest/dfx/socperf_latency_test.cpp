@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define private public
+#define protected public
+
+#include <gtest/gtest.h>
+#include "socperf_clock.h"
+#include "socperf_latency.h"
+
+using namespace testing::ext;
+
+namespace OHOS {
+namespace SOCPERF {
+class SocPerfLatencyTest : public testing::Test {
+public:
+    static void SetUpTestCase(void);
+    static void TearDownTestCase(void);
+    void SetUp();
+    void TearDown();
+};
+
+void SocPerfLatencyTest::SetUpTestCase(void)
+{
+}
+
+void SocPerfLatencyTest::TearDownTestCase(void)
+{
+}
+
+void SocPerfLatencyTest::SetUp(void)
+{
+}
+
+void SocPerfLatencyTest::TearDown(void)
+{
+    SocPerfLatency::GetInstance().Reset();
+}
+
+/*
+ * @tc.name: SocPerfLatencyTest : SocPerfLatencyTest_001
+ * @tc.desc: percentiles are reported as the upper bound of their log bucket
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfLatencyTest, SocPerfLatencyTest_001, Function | MediumTest | Level0)
+{
+    SocPerfHistogram histogram;
+    EXPECT_EQ(histogram.GetPercentile(0.5), 0);
+    for (int64_t us = 1; us <= 1000; us++) {
+        histogram.Record(us);
+    }
+    EXPECT_EQ(histogram.GetCount(), 1000);
+    EXPECT_GE(histogram.GetPercentile(0.5), 500);
+    EXPECT_LE(histogram.GetPercentile(0.5), 625);
+    EXPECT_GE(histogram.GetPercentile(0.99), 990);
+    histogram.Record(-1);
+    histogram.Record(INT64_MAX);
+    EXPECT_EQ(histogram.GetCount(), 1002);
+    histogram.Reset();
+    EXPECT_EQ(histogram.GetCount(), 0);
+}
+
+/*
+ * @tc.name: SocPerfLatencyTest : SocPerfLatencyTest_002
+ * @tc.desc: a traced request lands in its entry and cmdId histograms
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfLatencyTest, SocPerfLatencyTest_002, Function | MediumTest | Level0)
+{
+    SocPerfLatency& latency = SocPerfLatency::GetInstance();
+    LatencyTrace trace;
+    EXPECT_FALSE(SocPerfLatency::GetActiveRequest(trace));
+    latency.InitCmdIds({ 10000 });
+    SocPerfLatency::MarkAdmission();
+    {
+        SocPerfLatencyScope scope(RECORD_ENTRY_PERF_REQUEST, 10000);
+        EXPECT_TRUE(SocPerfLatency::GetActiveRequest(trace));
+    }
+    EXPECT_FALSE(SocPerfLatency::GetActiveRequest(trace));
+    EXPECT_GE(trace.enqueueUs, trace.admissionUs);
+    trace.dequeueUs = trace.enqueueUs + 20;
+    trace.arbitratedUs = trace.dequeueUs + 10;
+    latency.Record(trace);
+    EXPECT_EQ(latency.entryHistograms_[RECORD_ENTRY_PERF_REQUEST][LATENCY_STAGE_QUEUE].GetCount(), 1);
+    EXPECT_EQ(latency.entryHistograms_[RECORD_ENTRY_PERF_REQUEST][LATENCY_STAGE_REPORT].GetCount(), 0);
+    EXPECT_EQ(latency.cmdIdHistograms_[10000]->GetCount(), 1);
+    EXPECT_NE(latency.Dump().find("cmdId 10000"), std::string::npos);
+}
+/*
+ * @tc.name: SocPerfLatencyTest : SocPerfLatencyTest_003
+ * @tc.desc: an admission scope left without a request does not leak into the next request
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfLatencyTest, SocPerfLatencyTest_003, Function | MediumTest | Level0)
+{
+    SocPerfClock::GetInstance().EnableVirtualTime(1000);
+    {
+        SocPerfAdmissionScope admissionScope;
+    }
+    SocPerfClock::GetInstance().AdvanceTo(5000);
+    LatencyTrace trace;
+    {
+        SocPerfLatencyScope scope(RECORD_ENTRY_LIMIT_REQUEST, -1);
+        EXPECT_TRUE(SocPerfLatency::GetActiveRequest(trace));
+    }
+    EXPECT_EQ(trace.admissionUs, 5000);
+    {
+        SocPerfAdmissionScope admissionScope;
+        SocPerfClock::GetInstance().AdvanceTo(6000);
+        SocPerfLatencyScope scope(RECORD_ENTRY_PERF_REQUEST, 10000);
+        EXPECT_TRUE(SocPerfLatency::GetActiveRequest(trace));
+    }
+    EXPECT_EQ(trace.admissionUs, 5000);
+    EXPECT_EQ(trace.enqueueUs, 6000);
+    SocPerfClock::GetInstance().DisableVirtualTime();
+}
+/*
+ * @tc.name: SocPerfLatencyTest : SocPerfLatencyTest_004
+ * @tc.desc: a request submitted to several workers is traced by its first task only
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfLatencyTest, SocPerfLatencyTest_004, Function | MediumTest | Level0)
+{
+    LatencyTrace trace;
+    {
+        SocPerfLatencyScope scope(RECORD_ENTRY_POWER_LIMIT_BOOST, -1);
+        EXPECT_TRUE(SocPerfLatency::GetActiveRequest(trace));
+        EXPECT_FALSE(SocPerfLatency::GetActiveRequest(trace));
+    }
+    {
+        SocPerfLatencyScope scope(RECORD_ENTRY_POWER_LIMIT_BOOST, -1);
+        EXPECT_TRUE(SocPerfLatency::GetActiveRequest(trace));
+    }
+}
+} // namespace SOCPERF
+} // namespace OHOS
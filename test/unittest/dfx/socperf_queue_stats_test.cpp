@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define private public
+#define protected public
+
+#include <gtest/gtest.h>
+#include "socperf_clock.h"
+#include "socperf_queue_stats.h"
+
+using namespace testing::ext;
+
+namespace OHOS {
+namespace SOCPERF {
+class SocPerfQueueStatsTest : public testing::Test {
+public:
+    static void SetUpTestCase(void);
+    static void TearDownTestCase(void);
+    void SetUp();
+    void TearDown();
+};
+
+void SocPerfQueueStatsTest::SetUpTestCase(void)
+{
+}
+
+void SocPerfQueueStatsTest::TearDownTestCase(void)
+{
+}
+
+void SocPerfQueueStatsTest::SetUp(void)
+{
+    SocPerfClock::GetInstance().EnableVirtualTime(1000000);
+}
+
+void SocPerfQueueStatsTest::TearDown(void)
+{
+    SocPerfClock::GetInstance().DisableVirtualTime();
+}
+
+/*
+ * @tc.name: SocPerfQueueStatsTest : SocPerfQueueStatsTest_001
+ * @tc.desc: immediate tasks count as backlog until they start, the peak is kept
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfQueueStatsTest, SocPerfQueueStatsTest_001, Function | MediumTest | Level0)
+{
+    SocPerfQueueStats stats("test_queue");
+    int64_t dueUs1 = stats.OnSubmit(QUEUE_TASK_REQUEST, 0);
+    int64_t dueUs2 = stats.OnSubmit(QUEUE_TASK_REQUEST, 0);
+    int64_t dueUs3 = stats.OnSubmit(QUEUE_TASK_STATUS, 0);
+    EXPECT_EQ(stats.GetPendingCnt(), 3);
+    int64_t startUs = stats.OnStart(QUEUE_TASK_REQUEST, dueUs1, false);
+    SocPerfClock::GetInstance().AdvanceTo(startUs + 200);
+    stats.OnFinish(QUEUE_TASK_REQUEST, startUs);
+    stats.OnFinish(QUEUE_TASK_REQUEST, stats.OnStart(QUEUE_TASK_REQUEST, dueUs2, false));
+    stats.OnFinish(QUEUE_TASK_STATUS, stats.OnStart(QUEUE_TASK_STATUS, dueUs3, false));
+    EXPECT_EQ(stats.GetPendingCnt(), 0);
+    EXPECT_EQ(stats.GetMaxPendingCnt(), 3);
+    EXPECT_EQ(stats.taskStats_[QUEUE_TASK_REQUEST].runUs.GetCount(), 2);
+    EXPECT_EQ(stats.taskStats_[QUEUE_TASK_REQUEST].busyUs.load(), 200);
+    EXPECT_EQ(stats.taskStats_[QUEUE_TASK_REQUEST].lagUs.GetCount(), 0);
+    stats.Reset();
+    EXPECT_EQ(stats.GetMaxPendingCnt(), 0);
+    EXPECT_EQ(stats.taskStats_[QUEUE_TASK_REQUEST].runUs.GetCount(), 0);
+}
+
+/*
+ * @tc.name: SocPerfQueueStatsTest : SocPerfQueueStatsTest_002
+ * @tc.desc: delayed tasks are outstanding until due or canceled and record their start lag
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfQueueStatsTest, SocPerfQueueStatsTest_002, Function | MediumTest | Level0)
+{
+    SocPerfQueueStats stats("test_queue");
+    int64_t dueUs = stats.OnSubmit(QUEUE_TASK_EXPIRY, 20000);
+    stats.OnSubmit(QUEUE_TASK_EXPIRY, 50000);
+    EXPECT_EQ(stats.GetDelayedCnt(QUEUE_TASK_EXPIRY), 2);
+    EXPECT_EQ(stats.GetPendingCnt(), 0);
+    stats.OnCancel(QUEUE_TASK_EXPIRY, true);
+    EXPECT_EQ(stats.GetDelayedCnt(QUEUE_TASK_EXPIRY), 1);
+    SocPerfClock::GetInstance().AdvanceTo(dueUs + 3000);
+    stats.OnFinish(QUEUE_TASK_EXPIRY, stats.OnStart(QUEUE_TASK_EXPIRY, dueUs, true));
+    EXPECT_EQ(stats.GetDelayedCnt(QUEUE_TASK_EXPIRY), 0);
+    EXPECT_GE(stats.taskStats_[QUEUE_TASK_EXPIRY].lagUs.GetPercentile(0.5), 3000);
+    EXPECT_EQ(stats.GetDelayedCnt(QUEUE_TASK_MAX), 0);
+    std::string info = stats.Dump();
+    EXPECT_NE(info.find("expiry"), std::string::npos);
+    EXPECT_EQ(info.find("request"), std::string::npos);
+}
+} // namespace SOCPERF
+} // namespace OHOS
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define private public
+#define protected public
+
+#include <gtest/gtest.h>
+#include "socperf_recorder.h"
+
+using namespace testing::ext;
+
+namespace OHOS {
+namespace SOCPERF {
+class SocPerfRecorderTest : public testing::Test {
+public:
+    static void SetUpTestCase(void);
+    static void TearDownTestCase(void);
+    void SetUp();
+    void TearDown();
+};
+
+void SocPerfRecorderTest::SetUpTestCase(void)
+{
+}
+
+void SocPerfRecorderTest::TearDownTestCase(void)
+{
+}
+
+void SocPerfRecorderTest::SetUp(void)
+{
+}
+
+void SocPerfRecorderTest::TearDown(void)
+{
+}
+
+/*
+ * @tc.name: SocPerfRecorderTest : SocPerfRecorderTest_001
+ * @tc.desc: records survive the hex dump and parse back in order
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfRecorderTest, SocPerfRecorderTest_001, Function | MediumTest | Level0)
+{
+    SocPerfRecorder recorder;
+    recorder.Record(RECORD_ENTRY_PERF_REQUEST, 10000, true);
+    EXPECT_FALSE(recorder.IsRecording());
+    recorder.Start();
+    SocPerfRecorder::SetCallingPid(100);
+    recorder.Record(RECORD_ENTRY_PERF_REQUEST_EX, 10001, true);
+    recorder.Record(RECORD_ENTRY_LIMIT_REQUEST, 1, false, "", { 1001, 1002 }, { 600000, 900000 });
+    recorder.Record(RECORD_ENTRY_REQUEST_DEVICE_MODE, 0, true, "display=1");
+    recorder.Stop();
+    recorder.Record(RECORD_ENTRY_PERF_REQUEST, 10000, true);
+
+    std::string hex = SocPerfRecorder::ToHex(recorder.GetData());
+    std::vector<uint8_t> data;
+    EXPECT_TRUE(SocPerfRecorder::FromHex(hex.substr(0, 10) + "\n" + hex.substr(10), data));
+    std::vector<SocPerfRecord> records;
+    EXPECT_TRUE(SocPerfRecorder::Parse(data, records));
+    ASSERT_EQ(records.size(), 3);
+    EXPECT_EQ(records[0].entry, RECORD_ENTRY_PERF_REQUEST_EX);
+    EXPECT_EQ(records[0].id, 10001);
+    EXPECT_EQ(records[0].pid, 100);
+    EXPECT_TRUE(records[0].onOff);
+    EXPECT_EQ(records[1].tags, std::vector<int32_t>({ 1001, 1002 }));
+    EXPECT_EQ(records[1].configs, std::vector<int64_t>({ 600000, 900000 }));
+    EXPECT_EQ(records[2].str, "display=1");
+    EXPECT_LE(records[0].timestampUs, records[2].timestampUs);
+
+    data.pop_back();
+    records.clear();
+    EXPECT_FALSE(SocPerfRecorder::Parse(data, records));
+    EXPECT_FALSE(SocPerfRecorder::FromHex("5350zz", data));
+}
+/*
+ * @tc.name: SocPerfRecorderTest : SocPerfRecorderTest_002
+ * @tc.desc: the calling pid is only stamped on records made inside its scope
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfRecorderTest, SocPerfRecorderTest_002, Function | MediumTest | Level0)
+{
+    SocPerfRecorder recorder;
+    recorder.Start();
+    {
+        SocPerfCallingPidScope pidScope(200);
+        recorder.Record(RECORD_ENTRY_PERF_REQUEST_EX, 10001, true);
+    }
+    EXPECT_EQ(SocPerfRecorder::GetCallingPid(), 0);
+    recorder.Record(RECORD_ENTRY_PERF_REQUEST_EX, 10001, false);
+    recorder.Stop();
+    std::vector<SocPerfRecord> records;
+    EXPECT_TRUE(SocPerfRecorder::Parse(recorder.GetData(), records));
+    ASSERT_EQ(records.size(), 2);
+    EXPECT_EQ(records[0].pid, 200);
+    EXPECT_EQ(records[1].pid, 0);
+}
+} // namespace SOCPERF
+} // namespace OHOS
@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) 2025 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define private public
+#define protected public
+
+#include <gtest/gtest.h>
+#include "socperf_clock.h"
+#include "socperf_rate_limiter.h"
+
+using namespace testing::ext;
+
+namespace OHOS {
+namespace SOCPERF {
+namespace {
+    const int64_t BEGIN_US = 1000000;
+    const int64_t US_PER_MS = 1000;
+    const uint32_t CALLER_A = 1001;
+    const uint32_t CALLER_B = 1002;
+    const int32_t CMD_TOUCH = 10000;
+    const int32_t CMD_LAUNCH = 10001;
+    const int32_t CMD_HOLD = 10002;
+}
+
+class SocPerfRateLimiterTest : public testing::Test {
+public:
+    static void SetUpTestCase(void);
+    static void TearDownTestCase(void);
+    void SetUp();
+    void TearDown();
+
+protected:
+    std::unordered_map<int32_t, std::shared_ptr<Actions>> actionsInfo_;
+    void AddCmd(int32_t cmdId, int32_t duration, int32_t maxHoldMs);
+    void AdvanceMs(int64_t ms);
+    std::shared_ptr<RateLimitClass> MakeClass(const std::string& name, int32_t rate, int32_t burst,
+        const std::vector<int32_t>& cmdIds);
+};
+
+void SocPerfRateLimiterTest::SetUpTestCase(void)
+{
+}
+
+void SocPerfRateLimiterTest::TearDownTestCase(void)
+{
+}
+
+void SocPerfRateLimiterTest::SetUp(void)
+{
+    SocPerfClock::GetInstance().EnableVirtualTime(BEGIN_US);
+    actionsInfo_.clear();
+    AddCmd(CMD_TOUCH, 100, 0);
+    AddCmd(CMD_LAUNCH, 1000, 0);
+    AddCmd(CMD_HOLD, 0, 3000);
+}
+
+void SocPerfRateLimiterTest::TearDown(void)
+{
+    SocPerfClock::GetInstance().DisableVirtualTime();
+}
+
+void SocPerfRateLimiterTest::AddCmd(int32_t cmdId, int32_t duration, int32_t maxHoldMs)
+{
+    auto actions = std::make_shared<Actions>(cmdId, "cmd" + std::to_string(cmdId));
+    auto action = std::make_shared<Action>();
+    action->duration = duration;
+    actions->actionList.push_back(action);
+    actions->isLongTimePerf = duration == 0;
+    actions->maxHoldMs = maxHoldMs;
+    actionsInfo_[cmdId] = actions;
+}
+
+void SocPerfRateLimiterTest::AdvanceMs(int64_t ms)
+{
+    SocPerfClock& clock = SocPerfClock::GetInstance();
+    clock.AdvanceTo(clock.NowUs() + ms * US_PER_MS);
+}
+
+std::shared_ptr<RateLimitClass> SocPerfRateLimiterTest::MakeClass(const std::string& name, int32_t rate,
+    int32_t burst, const std::vector<int32_t>& cmdIds)
+{
+    auto rateLimitClass = std::make_shared<RateLimitClass>();
+    rateLimitClass->name = name;
+    rateLimitClass->rate = rate;
+    rateLimitClass->burst = burst;
+    rateLimitClass->cmdIds = cmdIds;
+    return rateLimitClass;
+}
+
+/*
+ * @tc.name: SocPerfRateLimiterTest : SocPerfRateLimiterTest_001
+ * @tc.desc: without rateLimit config every request is accepted
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfRateLimiterTest, SocPerfRateLimiterTest_001, Function | MediumTest | Level0)
+{
+    SocPerfRateLimiter limiter;
+    limiter.Init({}, 0, 0, actionsInfo_);
+    for (int32_t i = 0; i < 100; i++) {
+        EXPECT_TRUE(limiter.Acquire(CALLER_A, CMD_LAUNCH));
+    }
+    EXPECT_TRUE(limiter.callers_.empty());
+    EXPECT_EQ(limiter.Dump(), "rate limit: off\n");
+}
+
+/*
+ * @tc.name: SocPerfRateLimiterTest : SocPerfRateLimiterTest_002
+ * @tc.desc: the bucket allows a burst then refills at rate, per caller and per class
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfRateLimiterTest, SocPerfRateLimiterTest_002, Function | MediumTest | Level0)
+{
+    SocPerfRateLimiter limiter;
+    limiter.Init({ MakeClass("launch", 2, 3, { CMD_LAUNCH }), MakeClass("other", 10, 10, {}) }, 0, 0, actionsInfo_);
+    for (int32_t i = 0; i < 3; i++) {
+        EXPECT_TRUE(limiter.Acquire(CALLER_A, CMD_LAUNCH));
+    }
+    EXPECT_FALSE(limiter.Acquire(CALLER_A, CMD_LAUNCH));
+    // another caller and another class keep their own buckets
+    EXPECT_TRUE(limiter.Acquire(CALLER_B, CMD_LAUNCH));
+    EXPECT_TRUE(limiter.Acquire(CALLER_A, CMD_TOUCH));
+    AdvanceMs(499);
+    EXPECT_FALSE(limiter.Acquire(CALLER_A, CMD_LAUNCH));
+    AdvanceMs(1);
+    EXPECT_TRUE(limiter.Acquire(CALLER_A, CMD_LAUNCH));
+    EXPECT_FALSE(limiter.Acquire(CALLER_A, CMD_LAUNCH));
+    EXPECT_EQ(limiter.callers_[CALLER_A].rateRejected, 3);
+    EXPECT_EQ(limiter.callers_[CALLER_A].budgetRejected, 0);
+    // the bucket never holds more than burst
+    AdvanceMs(10000);
+    for (int32_t i = 0; i < 3; i++) {
+        EXPECT_TRUE(limiter.Acquire(CALLER_A, CMD_LAUNCH));
+    }
+    EXPECT_FALSE(limiter.Acquire(CALLER_A, CMD_LAUNCH));
+}
+
+/*
+ * @tc.name: SocPerfRateLimiterTest : SocPerfRateLimiterTest_003
+ * @tc.desc: the boost time of accepted requests is charged, the budget frees as the window slides
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfRateLimiterTest, SocPerfRateLimiterTest_003, Function | MediumTest | Level0)
+{
+    SocPerfRateLimiter limiter;
+    limiter.Init({}, 10000, 3000, actionsInfo_);
+    for (int32_t i = 0; i < 3; i++) {
+        EXPECT_TRUE(limiter.Acquire(CALLER_A, CMD_LAUNCH));
+        AdvanceMs(1000);
+    }
+    EXPECT_FALSE(limiter.Acquire(CALLER_A, CMD_TOUCH));
+    EXPECT_EQ(limiter.callers_[CALLER_A].budgetRejected, 1);
+    EXPECT_TRUE(limiter.Acquire(CALLER_B, CMD_LAUNCH));
+    // the first charge leaves the window 10s after it was made
+    AdvanceMs(7000);
+    EXPECT_TRUE(limiter.Acquire(CALLER_A, CMD_TOUCH));
+    EXPECT_EQ(limiter.GetUsedBudget(limiter.callers_[CALLER_A], SocPerfClock::GetInstance().NowMs()), 2100);
+}
+
+/*
+ * @tc.name: SocPerfRateLimiterTest : SocPerfRateLimiterTest_004
+ * @tc.desc: an open hold counts against the budget, the off charges it capped by maxHold
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfRateLimiterTest, SocPerfRateLimiterTest_004, Function | MediumTest | Level0)
+{
+    SocPerfRateLimiter limiter;
+    limiter.Init({}, 10000, 2000, actionsInfo_);
+    EXPECT_TRUE(limiter.Acquire(CALLER_A, CMD_HOLD));
+    limiter.Hold(CALLER_A, CMD_HOLD);
+    // a repeated on keeps the start of the first one
+    AdvanceMs(1000);
+    EXPECT_TRUE(limiter.Acquire(CALLER_A, CMD_HOLD));
+    limiter.Hold(CALLER_A, CMD_HOLD);
+    AdvanceMs(1000);
+    EXPECT_FALSE(limiter.Acquire(CALLER_A, CMD_TOUCH));
+    AdvanceMs(5000);
+    limiter.Release(CALLER_A, CMD_HOLD);
+    EXPECT_TRUE(limiter.callers_[CALLER_A].holds.empty());
+    EXPECT_EQ(limiter.callers_[CALLER_A].chargedMs, 3000);
+    // a release without an open hold charges nothing
+    limiter.Release(CALLER_A, CMD_HOLD);
+    limiter.Release(CALLER_B, CMD_HOLD);
+    EXPECT_EQ(limiter.callers_[CALLER_A].chargedMs, 3000);
+    AdvanceMs(10000);
+    EXPECT_TRUE(limiter.Acquire(CALLER_A, CMD_TOUCH));
+}
+
+/*
+ * @tc.name: SocPerfRateLimiterTest : SocPerfRateLimiterTest_005
+ * @tc.desc: a hold never turned off is closed at maxHold and ages out of the window
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfRateLimiterTest, SocPerfRateLimiterTest_005, Function | MediumTest | Level0)
+{
+    SocPerfRateLimiter limiter;
+    limiter.Init({}, 10000, 5000, actionsInfo_);
+    EXPECT_TRUE(limiter.Acquire(CALLER_A, CMD_HOLD));
+    limiter.Hold(CALLER_A, CMD_HOLD);
+    AdvanceMs(4000);
+    EXPECT_TRUE(limiter.Acquire(CALLER_A, CMD_TOUCH));
+    EXPECT_TRUE(limiter.callers_[CALLER_A].holds.empty());
+    EXPECT_EQ(limiter.callers_[CALLER_A].chargedMs, 3100);
+    AdvanceMs(10000);
+    EXPECT_EQ(limiter.GetUsedBudget(limiter.callers_[CALLER_A], SocPerfClock::GetInstance().NowMs()), 0);
+    std::string dump = limiter.Dump();
+    EXPECT_NE(dump.find("rate limit: budget 5000ms in 10000ms"), std::string::npos);
+    EXPECT_NE(dump.find("caller 1001: used 0ms, holds 0, rejected rate 0 budget 0"), std::string::npos);
+}
+
+/*
+ * @tc.name: SocPerfRateLimiterTest : SocPerfRateLimiterTest_006
+ * @tc.desc: clearing all perf requests ends every open hold, an on never held opens nothing
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfRateLimiterTest, SocPerfRateLimiterTest_006, Function | MediumTest | Level0)
+{
+    SocPerfRateLimiter limiter;
+    limiter.Init({}, 10000, 5000, actionsInfo_);
+    EXPECT_TRUE(limiter.Acquire(CALLER_A, CMD_HOLD));
+    EXPECT_TRUE(limiter.callers_[CALLER_A].holds.empty());
+    limiter.Hold(CALLER_A, CMD_HOLD);
+    limiter.Hold(CALLER_A, CMD_TOUCH);
+    EXPECT_TRUE(limiter.Acquire(CALLER_B, CMD_HOLD));
+    limiter.Hold(CALLER_B, CMD_HOLD);
+    AdvanceMs(1000);
+    limiter.ReleaseAll();
+    EXPECT_TRUE(limiter.callers_[CALLER_A].holds.empty());
+    EXPECT_TRUE(limiter.callers_[CALLER_B].holds.empty());
+    EXPECT_EQ(limiter.callers_[CALLER_A].chargedMs, 1000);
+    EXPECT_EQ(limiter.callers_[CALLER_B].chargedMs, 1000);
+}
+
+/*
+ * @tc.name: SocPerfRateLimiterTest : SocPerfRateLimiterTest_007
+ * @tc.desc: a full caller table evicts the least recently seen caller when none is idle
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfRateLimiterTest, SocPerfRateLimiterTest_007, Function | MediumTest | Level0)
+{
+    SocPerfRateLimiter limiter;
+    limiter.Init({}, 10000, 5000, actionsInfo_);
+    uint32_t callerCnt = static_cast<uint32_t>(SocPerfRateLimiter::MAX_CALLER_CNT);
+    for (uint32_t i = 0; i < callerCnt; i++) {
+        EXPECT_TRUE(limiter.Acquire(CALLER_A + i, CMD_TOUCH));
+        AdvanceMs(1);
+    }
+    // the first caller comes back, the second one is now the least recently seen
+    EXPECT_TRUE(limiter.Acquire(CALLER_A, CMD_TOUCH));
+    EXPECT_TRUE(limiter.Acquire(CALLER_A + callerCnt, CMD_TOUCH));
+    EXPECT_EQ(limiter.callers_.size(), static_cast<size_t>(callerCnt));
+    EXPECT_TRUE(limiter.callers_.find(CALLER_A) != limiter.callers_.end());
+    EXPECT_TRUE(limiter.callers_.find(CALLER_A + 1) == limiter.callers_.end());
+    EXPECT_TRUE(limiter.callers_.find(CALLER_A + callerCnt) != limiter.callers_.end());
+}
+} // namespace SOCPERF
+} // namespace OHOS
@@ -18,6 +18,9 @@
 
 #include <gtest/gtest.h>
 #include <gtest/hwext/gtest-multithread.h>
+#include <fstream>
+#include <future>
+#include "socperf_clock.h"
 #include "socperf_config.h"
 #include "isoc_perf.h"
 #include "socperf_server.h"
@@ -34,8 +37,12 @@ public:
     static void TearDownTestCase(void);
     void SetUp();
     void TearDown();
+protected:
+    // resources on ids the config leaves unused, ascending, removed again by TearDown
+    std::vector<int32_t> AddTestResNodes(int32_t cnt);
 private:
     std::shared_ptr<SocPerfServer> socPerfServer_ = DelayedSingleton<SocPerfServer>::GetInstance();
+    std::vector<int32_t> testResIds_;
 };
 
 void SocPerfServerTest::SetUpTestCase(void)
@@ -52,6 +59,32 @@ void SocPerfServerTest::SetUp(void)
 
 void SocPerfServerTest::TearDown(void)
 {
+    if (testResIds_.empty()) {
+        return;
+    }
+    SocPerfConfig& socPerfConfig = SocPerfConfig::GetInstance();
+    for (int32_t resId : testResIds_) {
+        socPerfConfig.resourceNodeInfo_.erase(resId);
+    }
+    testResIds_.clear();
+    socPerfConfig.BuildConstraintDomains();
+}
+
+std::vector<int32_t> SocPerfServerTest::AddTestResNodes(int32_t cnt)
+{
+    SocPerfConfig& socPerfConfig = SocPerfConfig::GetInstance();
+    std::vector<int32_t> resIds;
+    for (int32_t resId = MAX_RESOURCE_ID; resId >= MIN_RESOURCE_ID && (int32_t)resIds.size() < cnt; resId--) {
+        if (socPerfConfig.resourceNodeInfo_.find(resId) != socPerfConfig.resourceNodeInfo_.end()) {
+            continue;
+        }
+        socPerfConfig.resourceNodeInfo_[resId] =
+            std::make_shared<ResNode>(resId, "test_res", 0, INVALID_VALUE, REPORT_TO_PERFSO);
+        resIds.insert(resIds.begin(), resId);
+        testResIds_.push_back(resId);
+    }
+    EXPECT_EQ((int32_t)resIds.size(), cnt);
+    return resIds;
 }
 
 /*
@@ -205,33 +238,27 @@ HWTEST_F(SocPerfServerTest, SocPerfServerTest_SocPerfServerAPI_001, Function | M
 HWTEST_F(SocPerfServerTest, SocPerfServerTest_SocPerfServerAPI_002, Function | MediumTest | Level0)
 {
     std::string msg = "test";
+    uint64_t modeMask = socPerfServer_->socPerf.deviceModeMask_.load();
     socPerfServer_->RequestDeviceMode(msg, true);
-    auto iter = socPerfServer_->socPerf.recordDeviceMode_.find(msg);
-    EXPECT_TRUE(iter == socPerfServer_->socPerf.recordDeviceMode_.end());
+    EXPECT_EQ(socPerfServer_->socPerf.deviceModeMask_.load(), modeMask);
 
     socPerfServer_->RequestDeviceMode(msg, false);
-    auto iter2 = socPerfServer_->socPerf.recordDeviceMode_.find(msg);
-    EXPECT_TRUE(iter2 == socPerfServer_->socPerf.recordDeviceMode_.end());
+    EXPECT_EQ(socPerfServer_->socPerf.deviceModeMask_.load(), modeMask);
 
-    std::string msgEmpty = "";
     socPerfServer_->RequestDeviceMode("", true);
-    auto iter3 = socPerfServer_->socPerf.recordDeviceMode_.find(msgEmpty);
-    EXPECT_TRUE(iter3 == socPerfServer_->socPerf.recordDeviceMode_.end());
+    EXPECT_EQ(socPerfServer_->socPerf.deviceModeMask_.load(), modeMask);
 
     std::string msgMax = "ABCDEFGHABCDEFGHABCDEFGHABCDEFGHABCDEFGHABCDEFGHABCDEFGHABCDEFGHZ";
     socPerfServer_->RequestDeviceMode(msgMax, true);
-    auto iter4 = socPerfServer_->socPerf.recordDeviceMode_.find(msgMax);
-    EXPECT_TRUE(iter4 == socPerfServer_->socPerf.recordDeviceMode_.end());
+    EXPECT_EQ(socPerfServer_->socPerf.deviceModeMask_.load(), modeMask);
 
     std::string msgWeakInteractionStatus = "actionmode:weakaction";
     socPerfServer_->RequestDeviceMode(msgWeakInteractionStatus, true);
-    auto iter5 = socPerfServer_->socPerf.recordDeviceMode_.find(msgWeakInteractionStatus);
-    EXPECT_TRUE(iter5 == socPerfServer_->socPerf.recordDeviceMode_.end());
+    EXPECT_EQ(socPerfServer_->socPerf.deviceModeMask_.load(), modeMask);
 
     std::string msgWeakInteractionError = "actionmode:error";
     socPerfServer_->RequestDeviceMode(msgWeakInteractionError, true);
-    auto iter6 = socPerfServer_->socPerf.recordDeviceMode_.find(msgWeakInteractionError);
-    EXPECT_TRUE(iter6 == socPerfServer_->socPerf.recordDeviceMode_.end());
+    EXPECT_EQ(socPerfServer_->socPerf.deviceModeMask_.load(), modeMask);
 }
 
 /*
@@ -353,7 +380,7 @@ HWTEST_F(SocPerfServerTest, SocPerfServerTest_SocperfMatchCmd_003, Function | Me
     std::shared_ptr<Actions> actions = perfActionsInfo[cmdTest];
     std::shared_ptr<ModeMap> newMode = std::make_shared<ModeMap>(modeStr, cmdTest);
     actions->modeMap.push_back(newMode);
-    socPerfServer_->socPerf.recordDeviceMode_.clear();
+    socPerfServer_->socPerf.deviceModeMask_ = 0;
 
     // case : match device mode is empty branch
     int32_t retInvaild = socPerfServer_->socPerf.MatchDeviceModeCmd(cmdTest, true);
@@ -455,6 +482,67 @@ HWTEST_F(SocPerfServerTest, SocPerfServerTest_SocperfThreadWrapp_001, Function |
     EXPECT_FALSE(ret);
 }
 
+/*
+ * @tc.name: SocPerfServerTest_SocperfThreadWrapp_002
+ * @tc.desc: test level and nearest lookups on the sorted available table
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfServerTest, SocPerfServerTest_SocperfThreadWrapp_002, Function | MediumTest | Level0)
+{
+    int32_t testResId = AddTestResNodes(1)[0];
+    SocPerfConfig& socPerfConfig = SocPerfConfig::GetInstance();
+    auto resNode = std::make_shared<ResNode>(testResId, "test_res", 0, INVALID_VALUE, REPORT_TO_PERFSO);
+    resNode->AddAvailable(300);
+    resNode->AddAvailable(100);
+    resNode->AddAvailable(200);
+    resNode->AddAvailable(300);
+    std::vector<int64_t> sortedAvailable = {100, 200, 300};
+    EXPECT_EQ(resNode->available, sortedAvailable);
+    EXPECT_TRUE(resNode->IsAvailable(200));
+    EXPECT_FALSE(resNode->IsAvailable(250));
+    EXPECT_EQ(resNode->GetNearestAvailable(240), 200);
+    EXPECT_EQ(resNode->GetNearestAvailable(260), 300);
+    EXPECT_EQ(resNode->GetNearestAvailable(500), 300);
+    EXPECT_EQ(resNode->GetNearestAvailable(0), 100);
+    socPerfConfig.resourceNodeInfo_[testResId] = resNode;
+
+    auto socPerfThreadWrap = std::make_shared<SocPerfThreadWrap>();
+    int64_t value = 0;
+    EXPECT_TRUE(socPerfThreadWrap->GetResValueByLevel(testResId, 0, value));
+    EXPECT_EQ(value, 300);
+    EXPECT_TRUE(socPerfThreadWrap->GetResValueByLevel(testResId, 2, value));
+    EXPECT_EQ(value, 100);
+    EXPECT_TRUE(socPerfThreadWrap->GetResValueByLevel(testResId, 10, value));
+    EXPECT_EQ(value, 100);
+    EXPECT_FALSE(socPerfThreadWrap->GetResValueByLevel(testResId, -1, value));
+}
+
+/*
+ * @tc.name: SocPerfServerTest_SocperfThreadWrapp_003
+ * @tc.desc: test off-table values are snapped by the resource snap mode
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfServerTest, SocPerfServerTest_SocperfThreadWrapp_003, Function | MediumTest | Level0)
+{
+    auto resNode = std::make_shared<ResNode>(MAX_RESOURCE_ID, "test_res", 0, INVALID_VALUE, REPORT_TO_PERFSO);
+    resNode->AddAvailable(100);
+    resNode->AddAvailable(200);
+    resNode->AddAvailable(300);
+    EXPECT_EQ(resNode->SnapAvailable(250), 250);
+    resNode->snapMode = SNAP_MODE_FLOOR;
+    EXPECT_EQ(resNode->SnapAvailable(250), 200);
+    EXPECT_EQ(resNode->SnapAvailable(50), 100);
+    resNode->snapMode = SNAP_MODE_CEIL;
+    EXPECT_EQ(resNode->SnapAvailable(250), 300);
+    EXPECT_EQ(resNode->SnapAvailable(400), 300);
+    EXPECT_EQ(resNode->SnapAvailable(200), 200);
+    resNode->snapMode = SNAP_MODE_NEAREST;
+    EXPECT_EQ(resNode->SnapAvailable(240), 200);
+    EXPECT_EQ(resNode->SnapAvailable(260), 300);
+}
+
 class SocperfStubTest : public SocPerfStub {
 public:
     SocperfStubTest() {}
@@ -714,7 +802,9 @@ HWTEST_F(SocPerfServerTest, SocPerfServerTest_SetThermalLevel_Server_001, Functi
 HWTEST_F(SocPerfServerTest, SocPerfServerTest_SetThermalLevel_Server_002, Function | MediumTest | Level0)
 {
     socPerfServer_->SetThermalLevel(3);
-    EXPECT_EQ(socPerfServer_->socPerf.thermalLvl_, 3);
+    SocPerfStateSnapshot snapshot;
+    socPerfServer_->socPerf.socperfThreadWrap_->GetStateSnapshot(snapshot);
+    EXPECT_EQ(snapshot.thermalLvl, 3);
 }
 
 /*
@@ -728,18 +818,24 @@ HWTEST_F(SocPerfServerTest, SocPerfServerTest_SetThermalLevel_Server_005, Functi
     int32_t litCpuMinFreq = 1000;
     int32_t litCpuMaxFreq = 1001;
     std::shared_ptr<SocPerfThreadWrap> socPerfThreadWrap = socPerfServer_->socPerf.socperfThreadWrap_;
+    auto domainIter = socPerfThreadWrap->socPerfConfig_.resConstraintDomain_.find(litCpuMinFreq);
+    if (domainIter == socPerfThreadWrap->socPerfConfig_.resConstraintDomain_.end()) {
+        EXPECT_EQ(litCpuMinFreq, 1000);
+        return;
+    }
+    auto domain = socPerfThreadWrap->socPerfConfig_.constraintDomains_[domainIter->second];
     socPerfThreadWrap->resStatusInfo_[litCpuMinFreq]->candidatesValue[ACTION_TYPE_PERFLVL] = 1000;
-    bool ret = socPerfThreadWrap->ArbitratePairResInPerfLvl(litCpuMinFreq);
+    bool ret = socPerfThreadWrap->ExistPerfLvlInDomain(domain);
     EXPECT_TRUE(ret);
 
     socPerfThreadWrap->resStatusInfo_[litCpuMinFreq]->candidatesValue[ACTION_TYPE_PERFLVL] = INVALID_VALUE;
     socPerfThreadWrap->resStatusInfo_[litCpuMaxFreq]->candidatesValue[ACTION_TYPE_PERFLVL] = 1000;
-    ret = socPerfThreadWrap->ArbitratePairResInPerfLvl(litCpuMinFreq);
+    ret = socPerfThreadWrap->ExistPerfLvlInDomain(domain);
     EXPECT_TRUE(ret);
 
     socPerfThreadWrap->resStatusInfo_[litCpuMinFreq]->candidatesValue[ACTION_TYPE_PERFLVL] = INVALID_VALUE;
     socPerfThreadWrap->resStatusInfo_[litCpuMaxFreq]->candidatesValue[ACTION_TYPE_PERFLVL] = INVALID_VALUE;
-    ret = socPerfThreadWrap->ArbitratePairResInPerfLvl(litCpuMinFreq);
+    ret = socPerfThreadWrap->ExistPerfLvlInDomain(domain);
     EXPECT_FALSE(ret);
 }
 
@@ -756,6 +852,897 @@ HWTEST_F(SocPerfServerTest, SocPerfServerTest_SetThermalLevel_Server_006, Functi
     EXPECT_TRUE(ret);
 }
 
+namespace {
+int32_t g_reportRet = 0;
+std::vector<int32_t> g_reportResIds;
+int ReportDataStub(const std::vector<int32_t>& resId, const std::vector<int64_t>& value,
+    const std::vector<int64_t>& endTime, const std::string& msgStr)
+{
+    g_reportResIds = resId;
+    return g_reportRet;
+}
+}
+
+/*
+ * @tc.name: SocPerfServerTest_SendResStatus_001
+ * @tc.desc: test resource is resent until the backend acknowledges it
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfServerTest, SocPerfServerTest_SendResStatus_001, Function | MediumTest | Level0)
+{
+    int32_t testResId = AddTestResNodes(1)[0];
+    SocPerfConfig& socPerfConfig = SocPerfConfig::GetInstance();
+    ReportDataFunc originReportFunc = socPerfConfig.reportFunc_;
+    socPerfConfig.reportFunc_ = ReportDataStub;
+    auto socPerfThreadWrap = std::make_shared<SocPerfThreadWrap>();
+    auto resStatus = std::make_shared<ResStatus>();
+    socPerfThreadWrap->resStatusInfo_[testResId] = resStatus;
+    resStatus->currentValue = 1000;
+
+    g_reportRet = -1;
+    socPerfThreadWrap->SendResStatus();
+    EXPECT_EQ(resStatus->previousValue, NODE_DEFAULT_VALUE);
+    g_reportRet = 0;
+    socPerfThreadWrap->SendResStatus();
+    EXPECT_EQ(resStatus->previousValue, 1000);
+
+    int64_t nodeValue = 0;
+    EXPECT_FALSE(socPerfThreadWrap->ReadResNodeValue("/invalid/socperf/node", nodeValue));
+    socPerfConfig.reportFunc_ = originReportFunc;
+}
+
+/*
+ * @tc.name: SocPerfServerTest_SendResStatus_003
+ * @tc.desc: test a retry is still armed after the quick retries run out
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfServerTest, SocPerfServerTest_SendResStatus_003, Function | MediumTest | Level0)
+{
+    int32_t testResId = AddTestResNodes(1)[0];
+    SocPerfConfig& socPerfConfig = SocPerfConfig::GetInstance();
+    ReportDataFunc originReportFunc = socPerfConfig.reportFunc_;
+    socPerfConfig.reportFunc_ = ReportDataStub;
+    auto socPerfThreadWrap = std::make_shared<SocPerfThreadWrap>();
+    auto resStatus = std::make_shared<ResStatus>();
+    socPerfThreadWrap->resStatusInfo_[testResId] = resStatus;
+    resStatus->currentValue = 1000;
+
+    int32_t maxRetryTimes = SocPerfThreadWrap::MAX_REPORT_RETRY_TIMES;
+    g_reportRet = -1;
+    socPerfThreadWrap->reportRetryCnt_ = maxRetryTimes;
+    socPerfThreadWrap->SendResStatus();
+    EXPECT_TRUE(socPerfThreadWrap->reportRetryPending_);
+    EXPECT_EQ(socPerfThreadWrap->reportRetryCnt_, maxRetryTimes);
+    g_reportRet = 0;
+    socPerfThreadWrap->SendResStatus();
+    EXPECT_EQ(resStatus->previousValue, 1000);
+    EXPECT_EQ(socPerfThreadWrap->reportRetryCnt_, 0);
+    socPerfConfig.reportFunc_ = originReportFunc;
+}
+
+/*
+ * @tc.name: SocPerfServerTest_SendResStatus_002
+ * @tc.desc: test min/max pair is reported in the order the kernel accepts
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfServerTest, SocPerfServerTest_SendResStatus_002, Function | MediumTest | Level0)
+{
+    std::vector<int32_t> resIds = AddTestResNodes(2);
+    int32_t minResId = resIds[0];
+    int32_t maxResId = resIds[1];
+    SocPerfConfig& socPerfConfig = SocPerfConfig::GetInstance();
+    socPerfConfig.resourceNodeInfo_[minResId] =
+        std::make_shared<ResNode>(minResId, "test_min", 0, maxResId, REPORT_TO_PERFSO);
+    socPerfConfig.resourceNodeInfo_[maxResId] =
+        std::make_shared<ResNode>(maxResId, "test_max", MAX_FREQUE_NODE, minResId, REPORT_TO_PERFSO);
+    ReportDataFunc originReportFunc = socPerfConfig.reportFunc_;
+    socPerfConfig.reportFunc_ = ReportDataStub;
+    socPerfConfig.BuildConstraintDomains();
+    g_reportRet = 0;
+    auto socPerfThreadWrap = std::make_shared<SocPerfThreadWrap>();
+    auto minResStatus = std::make_shared<ResStatus>();
+    auto maxResStatus = std::make_shared<ResStatus>();
+    socPerfThreadWrap->resStatusInfo_[minResId] = minResStatus;
+    socPerfThreadWrap->resStatusInfo_[maxResId] = maxResStatus;
+
+    minResStatus->currentValue = 1000;
+    maxResStatus->currentValue = 1200;
+    socPerfThreadWrap->SendResStatus();
+    minResStatus->currentValue = 1500;
+    maxResStatus->currentValue = 1800;
+    socPerfThreadWrap->SendResStatus();
+    std::vector<int32_t> raiseOrder = {maxResId, minResId};
+    EXPECT_EQ(g_reportResIds, raiseOrder);
+
+    minResStatus->currentValue = 500;
+    maxResStatus->currentValue = 800;
+    socPerfThreadWrap->SendResStatus();
+    std::vector<int32_t> lowerOrder = {minResId, maxResId};
+    EXPECT_EQ(g_reportResIds, lowerOrder);
+
+    socPerfConfig.reportFunc_ = originReportFunc;
+}
+
+/*
+ * @tc.name: SocPerfServerTest_ReadBack_001
+ * @tc.desc: test read back only runs while a node is held and ignores the kernel rounding
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfServerTest, SocPerfServerTest_ReadBack_001, Function | MediumTest | Level0)
+{
+    int32_t testResId = AddTestResNodes(1)[0];
+    SocPerfConfig& socPerfConfig = SocPerfConfig::GetInstance();
+    auto resNode = std::make_shared<ResNode>(testResId, "test_read_back", 0, INVALID_VALUE, WRITE_NODE);
+    resNode->path = "socperf_read_back_node";
+    resNode->readBack = true;
+    resNode->available = {1000, 2000};
+    socPerfConfig.resourceNodeInfo_[testResId] = resNode;
+    auto socPerfThreadWrap = std::make_shared<SocPerfThreadWrap>();
+    auto resStatus = std::make_shared<ResStatus>();
+    socPerfThreadWrap->resStatusInfo_[testResId] = resStatus;
+    socPerfThreadWrap->readBackResIds_ = {testResId};
+    socPerfThreadWrap->StartReadBackTimer();
+    EXPECT_FALSE(socPerfThreadWrap->readBackTimerPending_);
+
+    resStatus->currentValue = 1000;
+    resStatus->previousValue = 1000;
+    std::ofstream("socperf_read_back_node") << 1003;
+    socPerfThreadWrap->DoReconcileResStatus();
+    EXPECT_EQ(resStatus->previousValue, 1000);
+    std::ofstream("socperf_read_back_node") << 2000;
+    socPerfThreadWrap->DoReconcileResStatus();
+    EXPECT_EQ(resStatus->previousValue, 1000);
+    EXPECT_TRUE(socPerfThreadWrap->readBackTimerPending_);
+    remove("socperf_read_back_node");
+}
+
+/*
+ * @tc.name: SocPerfServerTest_ConstraintGroup_001
+ * @tc.desc: test order and follow constraint groups are arbitrated together
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfServerTest, SocPerfServerTest_ConstraintGroup_001, Function | MediumTest | Level0)
+{
+    std::vector<int32_t> resIds = AddTestResNodes(4);
+    SocPerfConfig& socPerfConfig = SocPerfConfig::GetInstance();
+    auto orderGroup = std::make_shared<ConstraintGroup>("test_order", CONSTRAINT_TYPE_ORDER);
+    orderGroup->resIds = {resIds[0], resIds[1], resIds[2]};
+    auto followGroup = std::make_shared<ConstraintGroup>("test_follow", CONSTRAINT_TYPE_FOLLOW);
+    followGroup->resIds = {resIds[3], resIds[0]};
+    followGroup->floorMap = {{1000, 300}, {2000, 600}};
+    socPerfConfig.constraintGroups_.push_back(orderGroup);
+    socPerfConfig.constraintGroups_.push_back(followGroup);
+    EXPECT_TRUE(socPerfConfig.BuildConstraintDomains());
+    int32_t domainId = socPerfConfig.resConstraintDomain_[resIds[0]];
+    EXPECT_EQ(socPerfConfig.resConstraintDomain_[resIds[3]], domainId);
+
+    auto socPerfThreadWrap = std::make_shared<SocPerfThreadWrap>();
+    for (int32_t resId : resIds) {
+        socPerfThreadWrap->resStatusInfo_[resId] = std::make_shared<ResStatus>();
+    }
+    socPerfThreadWrap->resStatusInfo_[resIds[0]]->candidate = 200;
+    socPerfThreadWrap->resStatusInfo_[resIds[1]]->candidate = 100;
+    socPerfThreadWrap->resStatusInfo_[resIds[2]]->candidate = 400;
+    socPerfThreadWrap->resStatusInfo_[resIds[3]]->candidate = 2500;
+    socPerfThreadWrap->ArbitrateConstraintDomain(domainId);
+    EXPECT_EQ(socPerfThreadWrap->resStatusInfo_[resIds[0]]->currentValue, 600);
+    EXPECT_EQ(socPerfThreadWrap->resStatusInfo_[resIds[1]]->currentValue, 600);
+    EXPECT_EQ(socPerfThreadWrap->resStatusInfo_[resIds[2]]->currentValue, 600);
+
+    socPerfThreadWrap->powerLimitBoost_ = true;
+    socPerfThreadWrap->resStatusInfo_[resIds[3]]->candidate = NODE_DEFAULT_VALUE;
+    socPerfThreadWrap->ArbitrateConstraintDomain(domainId);
+    EXPECT_EQ(socPerfThreadWrap->resStatusInfo_[resIds[0]]->currentValue, 100);
+    EXPECT_EQ(socPerfThreadWrap->resStatusInfo_[resIds[1]]->currentValue, 100);
+    EXPECT_EQ(socPerfThreadWrap->resStatusInfo_[resIds[2]]->currentValue, 400);
+
+    socPerfConfig.constraintGroups_.pop_back();
+    socPerfConfig.constraintGroups_.pop_back();
+}
+
+/*
+ * @tc.name: SocPerfServerTest_Clock_001
+ * @tc.desc: test request debouncing follows the injected clock instead of the wall clock
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfServerTest, SocPerfServerTest_Clock_001, Function | MediumTest | Level0)
+{
+    SocPerfClock& clock = SocPerfClock::GetInstance();
+    int64_t beginUs = clock.NowUs();
+    clock.EnableVirtualTime(beginUs);
+    EXPECT_TRUE(clock.IsVirtualTime());
+    clock.AdvanceTo(beginUs - 1000);
+    EXPECT_EQ(clock.NowUs(), beginUs);
+
+    SocPerf socPerf;
+    int32_t cmdId = 10000;
+    EXPECT_TRUE(socPerf.CheckTimeInterval(true, cmdId));
+    clock.AdvanceTo(beginUs + 5000);
+    EXPECT_FALSE(socPerf.CheckTimeInterval(true, cmdId));
+    clock.AdvanceTo(beginUs + 20000);
+    EXPECT_TRUE(socPerf.CheckTimeInterval(true, cmdId));
+    EXPECT_EQ(clock.NowMs(), (beginUs + 20000) / 1000);
+
+    clock.DisableVirtualTime();
+    EXPECT_FALSE(clock.IsVirtualTime());
+    EXPECT_GE(clock.NowUs(), beginUs);
+}
+
+/*
+ * @tc.name: SocPerfServerTest_StateInfo_001
+ * @tc.desc: test the state dump shows limits and resource status taken on the queue
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfServerTest, SocPerfServerTest_StateInfo_001, Function | MediumTest | Level0)
+{
+    socPerfServer_->socPerf.LimitRequest(ActionType::ACTION_TYPE_POWER, {1001}, {999000}, "");
+    std::string state = socPerfServer_->socPerf.GetStateInfo();
+    EXPECT_NE(state.find("snapshot queue wait"), std::string::npos);
+    EXPECT_NE(state.find("1001=999000"), std::string::npos);
+    EXPECT_NE(state.find("resources:"), std::string::npos);
+    socPerfServer_->socPerf.LimitRequest(ActionType::ACTION_TYPE_POWER, {1001}, {-1}, "");
+
+    int32_t fd = -1;
+    std::vector<std::u16string> args = {to_utf16("-a")};
+    EXPECT_EQ(socPerfServer_->Dump(fd, args), ERR_OK);
+}
+
+/*
+ * @tc.name: SocPerfServerTest_Supersede_001
+ * @tc.desc: test a queued timed pack is skipped once a newer one of the same cmdId is queued
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfServerTest, SocPerfServerTest_Supersede_001, Function | MediumTest | Level0)
+{
+    auto socPerfThreadWrap = std::make_shared<SocPerfThreadWrap>();
+    int32_t cmdId = 10010;
+    int64_t nowMs = SocPerfClock::GetInstance().NowMs();
+    auto item = std::make_shared<ResActionItem>(1000);
+    item->resAction = std::make_shared<ResAction>(1000, 10, ACTION_TYPE_PERF, EVENT_INVALID, cmdId, nowMs + 10);
+    EXPECT_TRUE(socPerfThreadWrap->IsPackSupersedable(item));
+    EXPECT_FALSE(socPerfThreadWrap->IsResActionExpired(item->resAction, nowMs));
+    EXPECT_TRUE(socPerfThreadWrap->IsResActionExpired(item->resAction, nowMs + 10));
+    auto onItem = std::make_shared<ResActionItem>(1000);
+    onItem->resAction = std::make_shared<ResAction>(1000, 0, ACTION_TYPE_PERF, EVENT_ON, cmdId, MAX_INT_VALUE);
+    EXPECT_FALSE(socPerfThreadWrap->IsPackSupersedable(onItem));
+    EXPECT_FALSE(socPerfThreadWrap->IsResActionExpired(onItem->resAction, nowMs));
+
+    auto started = std::make_shared<std::promise<void>>();
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    socPerfThreadWrap->SubmitQueueTask(QUEUE_TASK_STATUS, [started, opened]() {
+        started->set_value();
+        opened.wait();
+    });
+    started->get_future().wait();
+    socPerfThreadWrap->DoFreqActionPack(item);
+    socPerfThreadWrap->DoFreqActionPack(item);
+    EXPECT_EQ(socPerfThreadWrap->queueStats_.GetPendingCnt(), 2);
+    gate.set_value();
+    SocPerfStateSnapshot snapshot;
+    socPerfThreadWrap->GetStateSnapshot(snapshot);
+    EXPECT_EQ(socPerfThreadWrap->queueStats_.supersededCnt_.load(), 1);
+    EXPECT_FALSE(socPerfThreadWrap->IsPackSuperseded(cmdId, socPerfThreadWrap->latestPackSeq_[cmdId]));
+}
+
+/*
+ * @tc.name: SocPerfServerTest_LimitLane_001
+ * @tc.desc: test limit traffic queued behind boosts runs first and keeps its own order
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfServerTest, SocPerfServerTest_LimitLane_001, Function | MediumTest | Level0)
+{
+    auto socPerfThreadWrap = std::make_shared<SocPerfThreadWrap>();
+    auto started = std::make_shared<std::promise<void>>();
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    socPerfThreadWrap->SubmitQueueTask(QUEUE_TASK_STATUS, [started, opened]() {
+        started->set_value();
+        opened.wait();
+    });
+    started->get_future().wait();
+    std::vector<int32_t> order;
+    socPerfThreadWrap->SubmitRequestTask(QUEUE_TASK_REQUEST, [&order]() { order.push_back(1); });
+    socPerfThreadWrap->SubmitRequestTask(QUEUE_TASK_REQUEST, [&order]() { order.push_back(2); });
+    socPerfThreadWrap->SubmitRequestTask(QUEUE_TASK_LIMIT, [&order]() { order.push_back(3); });
+    socPerfThreadWrap->SubmitRequestTask(QUEUE_TASK_LIMIT, [&order]() { order.push_back(4); });
+    gate.set_value();
+    SocPerfStateSnapshot snapshot;
+    socPerfThreadWrap->GetStateSnapshot(snapshot);
+    std::vector<int32_t> expected = {3, 4, 1, 2};
+    EXPECT_EQ(order, expected);
+}
+
+/*
+ * @tc.name: SocPerfServerTest_Workers_001
+ * @tc.desc: test a constraint domain stays on one worker and independent resources are spread
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfServerTest, SocPerfServerTest_Workers_001, Function | MediumTest | Level0)
+{
+    std::vector<int32_t> resIds = AddTestResNodes(4);
+    SocPerfConfig& socPerfConfig = SocPerfConfig::GetInstance();
+    auto orderGroup = std::make_shared<ConstraintGroup>("test_order", CONSTRAINT_TYPE_ORDER);
+    orderGroup->resIds = {resIds[0], resIds[1]};
+    socPerfConfig.constraintGroups_.push_back(orderGroup);
+    socPerfConfig.workerCnt_ = 2;
+    EXPECT_TRUE(socPerfConfig.BuildConstraintDomains());
+    EXPECT_EQ(socPerfConfig.GetWorkerId(resIds[0]), socPerfConfig.GetWorkerId(resIds[1]));
+    EXPECT_EQ(socPerfConfig.GetWorkerId(resIds[0] + RES_ID_ADDITION), socPerfConfig.GetWorkerId(resIds[0]));
+    std::vector<int32_t> workerResCnt(socPerfConfig.workerCnt_, 0);
+    for (const auto& item : socPerfConfig.resourceNodeInfo_) {
+        int32_t workerId = socPerfConfig.GetWorkerId(item.first);
+        EXPECT_TRUE(workerId >= 0 && workerId < socPerfConfig.workerCnt_);
+        workerResCnt[workerId]++;
+    }
+    EXPECT_GT(workerResCnt[0], 0);
+    EXPECT_GT(workerResCnt[1], 0);
+    EXPECT_EQ(socPerfConfig.GetWorkerId(INVALID_VALUE), 0);
+
+    socPerfConfig.workerCnt_ = 1;
+    socPerfConfig.constraintGroups_.pop_back();
+    socPerfConfig.BuildConstraintDomains();
+    EXPECT_EQ(socPerfConfig.GetWorkerId(resIds[0]), 0);
+}
+
+/*
+ * @tc.name: SocPerfServerTest_HoldIndex_001
+ * @tc.desc: test PerfRequestEx OFF releases the matching holds through the index
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfServerTest, SocPerfServerTest_HoldIndex_001, Function | MediumTest | Level0)
+{
+    std::vector<int32_t> resIds = AddTestResNodes(2);
+    auto socPerfThreadWrap = std::make_shared<SocPerfThreadWrap>();
+    for (int32_t resId : resIds) {
+        socPerfThreadWrap->resStatusInfo_[resId] = std::make_shared<ResStatus>();
+    }
+    const int32_t cmdId = 10000;
+    for (int32_t resId : resIds) {
+        socPerfThreadWrap->UpdateResActionList(resId,
+            std::make_shared<ResAction>(1000, 0, ACTION_TYPE_PERF, EVENT_ON, cmdId, MAX_INT_VALUE), false);
+    }
+    // a repeated ON replaces the previous hold
+    socPerfThreadWrap->UpdateResActionList(resIds[0],
+        std::make_shared<ResAction>(1000, 0, ACTION_TYPE_PERF, EVENT_ON, cmdId, MAX_INT_VALUE), false);
+    socPerfThreadWrap->UpdateResActionList(resIds[0],
+        std::make_shared<ResAction>(2000, 0, ACTION_TYPE_PERF, EVENT_ON, cmdId + 1, MAX_INT_VALUE), false);
+    auto& holds = socPerfThreadWrap->holdIndex_[std::make_pair(cmdId, (int32_t)ACTION_TYPE_PERF)];
+    EXPECT_EQ(holds.size(), resIds.size());
+    EXPECT_EQ(holds[resIds[0]].size(), 1);
+    EXPECT_EQ(socPerfThreadWrap->resStatusInfo_[resIds[0]]->resActionList[ACTION_TYPE_PERF].size(), 2);
+
+    socPerfThreadWrap->UpdateResActionList(resIds[0],
+        std::make_shared<ResAction>(1000, 0, ACTION_TYPE_PERF, EVENT_OFF, cmdId, MAX_INT_VALUE), false);
+    EXPECT_EQ(socPerfThreadWrap->resStatusInfo_[resIds[0]]->resActionList[ACTION_TYPE_PERF].size(), 1);
+    EXPECT_EQ(socPerfThreadWrap->resStatusInfo_[resIds[0]]->candidatesValue[ACTION_TYPE_PERF], 2000);
+    socPerfThreadWrap->UpdateResActionList(resIds[1],
+        std::make_shared<ResAction>(1000, 0, ACTION_TYPE_PERF, EVENT_OFF, cmdId, MAX_INT_VALUE), false);
+    EXPECT_TRUE(socPerfThreadWrap->resStatusInfo_[resIds[1]]->resActionList[ACTION_TYPE_PERF].empty());
+    EXPECT_EQ(socPerfThreadWrap->holdIndex_.size(), 1);
+
+    socPerfThreadWrap->UpdateResActionList(resIds[0],
+        std::make_shared<ResAction>(2000, 0, ACTION_TYPE_PERF, EVENT_OFF, cmdId + 1, MAX_INT_VALUE), false);
+    EXPECT_TRUE(socPerfThreadWrap->holdIndex_.empty());
+}
+
+/*
+ * @tc.name: SocPerfServerTest_LimitPack_001
+ * @tc.desc: test all tags of a LimitRequest are applied by a single queue task
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfServerTest, SocPerfServerTest_LimitPack_001, Function | MediumTest | Level0)
+{
+    std::vector<int32_t> resIds = AddTestResNodes(2);
+    auto socPerfThreadWrap = std::make_shared<SocPerfThreadWrap>();
+    for (int32_t resId : resIds) {
+        socPerfThreadWrap->resStatusInfo_[resId] = std::make_shared<ResStatus>();
+    }
+    auto started = std::make_shared<std::promise<void>>();
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    socPerfThreadWrap->SubmitQueueTask(QUEUE_TASK_STATUS, [started, opened]() {
+        started->set_value();
+        opened.wait();
+    });
+    started->get_future().wait();
+    auto header = std::make_shared<ResActionItem>(resIds[0]);
+    header->resAction = std::make_shared<ResAction>(1000, 0, ACTION_TYPE_POWER, EVENT_ON, -1, MAX_INT_VALUE);
+    header->next = std::make_shared<ResActionItem>(resIds[1]);
+    header->next->resAction = std::make_shared<ResAction>(2000, 0, ACTION_TYPE_POWER, EVENT_ON, -1, MAX_INT_VALUE);
+    socPerfThreadWrap->UpdateLimitStatusPack(header);
+    EXPECT_EQ(socPerfThreadWrap->queueStats_.GetPendingCnt(), 1);
+    gate.set_value();
+    SocPerfStateSnapshot snapshot;
+    socPerfThreadWrap->GetStateSnapshot(snapshot);
+    EXPECT_EQ(snapshot.resStatus[resIds[0]].candidatesValue[ACTION_TYPE_POWER], 1000);
+    EXPECT_EQ(snapshot.resStatus[resIds[1]].candidatesValue[ACTION_TYPE_POWER], 2000);
+}
+
+/*
+ * @tc.name: SocPerfServerTest_LimitTable_001
+ * @tc.desc: test LimitRequest values are kept per client on the queue without truncation
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfServerTest, SocPerfServerTest_LimitTable_001, Function | MediumTest | Level0)
+{
+    std::vector<int32_t> resIds = AddTestResNodes(2);
+    SocPerfConfig& socPerfConfig = SocPerfConfig::GetInstance();
+    EXPECT_TRUE(socPerfConfig.BuildConstraintDomains());
+    EXPECT_NE(socPerfConfig.GetResSlot(resIds[0]), INVALID_VALUE);
+    auto socPerfThreadWrap = std::make_shared<SocPerfThreadWrap>();
+    for (int32_t resId : resIds) {
+        socPerfThreadWrap->resStatusInfo_[resId] = std::make_shared<ResStatus>();
+    }
+    socPerfThreadWrap->InitLimitRequest();
+    const int64_t largeValue = 5000000000;
+    socPerfThreadWrap->UpdateLimitRequest(ACTION_TYPE_POWER, resIds, {largeValue, 1000});
+    socPerfThreadWrap->UpdateLimitRequest(ACTION_TYPE_BATTERY, {resIds[0]}, {2000});
+    SocPerfStateSnapshot snapshot;
+    socPerfThreadWrap->GetStateSnapshot(snapshot);
+    EXPECT_EQ(snapshot.limitRequests[ACTION_TYPE_POWER][resIds[0]], largeValue);
+    EXPECT_EQ(snapshot.limitRequests[ACTION_TYPE_POWER][resIds[1]], 1000);
+    EXPECT_EQ(snapshot.limitRequests[ACTION_TYPE_BATTERY][resIds[0]], 2000);
+    EXPECT_EQ(snapshot.resStatus[resIds[0]].candidatesValue[ACTION_TYPE_POWER], 2000);
+
+    // a reset of one client leaves the others in place
+    socPerfThreadWrap->UpdateLimitRequest(ACTION_TYPE_POWER, resIds, {RESET_VALUE, RESET_VALUE});
+    SocPerfStateSnapshot resetSnapshot;
+    socPerfThreadWrap->GetStateSnapshot(resetSnapshot);
+    EXPECT_TRUE(resetSnapshot.limitRequests[ACTION_TYPE_POWER].empty());
+    EXPECT_EQ(resetSnapshot.limitRequests[ACTION_TYPE_BATTERY][resIds[0]], 2000);
+    EXPECT_EQ(resetSnapshot.resStatus[resIds[0]].candidatesValue[ACTION_TYPE_POWER], 2000);
+    EXPECT_EQ(resetSnapshot.resStatus[resIds[1]].candidatesValue[ACTION_TYPE_POWER], INVALID_VALUE);
+}
+
+/*
+ * @tc.name: SocPerfServerTest_ThermalLvl_001
+ * @tc.desc: test a thermal level change re-arbitrates the live perf level actions
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfServerTest, SocPerfServerTest_ThermalLvl_001, Function | MediumTest | Level0)
+{
+    int32_t resId = AddTestResNodes(1)[0];
+    SocPerfConfig& socPerfConfig = SocPerfConfig::GetInstance();
+    int32_t minThermalLvl = socPerfConfig.minThermalLvl_;
+    socPerfConfig.minThermalLvl_ = 1;
+    auto thermalActions = std::make_shared<Actions>(0, "thermal");
+    const std::vector<std::pair<int32_t, int64_t>> levels = {{1, 1000}, {3, 500}};
+    for (const auto& level : levels) {
+        auto action = std::make_shared<Action>();
+        action->thermalLvl_ = level.first;
+        action->variable = {resId, level.second};
+        thermalActions->actionList.push_back(action);
+    }
+    socPerfConfig.BuildThermalLvlTable(thermalActions);
+    EXPECT_EQ(thermalActions->thermalResIds, std::vector<int32_t>({resId}));
+    EXPECT_EQ(thermalActions->GetThermalLvlValue(0, 0), INVALID_VALUE);
+    EXPECT_EQ(thermalActions->GetThermalLvlValue(2, 0), 1000);
+    EXPECT_EQ(thermalActions->GetThermalLvlValue(5, 0), 500);
+
+    auto socPerfThreadWrap = std::make_shared<SocPerfThreadWrap>();
+    socPerfThreadWrap->resStatusInfo_[resId] = std::make_shared<ResStatus>();
+    socPerfThreadWrap->SetThermalLevel(2);
+    auto head = std::make_shared<ResActionItem>(resId);
+    head->resAction = std::make_shared<ResAction>(INVALID_VALUE, 0, ACTION_TYPE_PERFLVL, EVENT_ON, 1, MAX_INT_VALUE);
+    head->resAction->thermalActions = thermalActions;
+    socPerfThreadWrap->DoFreqActionPack(head);
+    SocPerfStateSnapshot snapshot;
+    socPerfThreadWrap->GetStateSnapshot(snapshot);
+    EXPECT_EQ(snapshot.resStatus[resId].candidatesValue[ACTION_TYPE_PERFLVL], 1000);
+
+    // the hold issued at level 2 follows the device as it heats up and cools down
+    socPerfThreadWrap->SetThermalLevel(3);
+    SocPerfStateSnapshot hotSnapshot;
+    socPerfThreadWrap->GetStateSnapshot(hotSnapshot);
+    EXPECT_EQ(hotSnapshot.thermalLvl, 3);
+    EXPECT_EQ(hotSnapshot.resStatus[resId].candidatesValue[ACTION_TYPE_PERFLVL], 500);
+    EXPECT_EQ(hotSnapshot.resStatus[resId].candidate, 500);
+    socPerfThreadWrap->SetThermalLevel(0);
+    SocPerfStateSnapshot coolSnapshot;
+    socPerfThreadWrap->GetStateSnapshot(coolSnapshot);
+    EXPECT_EQ(coolSnapshot.resStatus[resId].candidatesValue[ACTION_TYPE_PERFLVL], INVALID_VALUE);
+
+    // the release matches its hold whatever level it was issued at
+    auto offHead = std::make_shared<ResActionItem>(resId);
+    offHead->resAction = std::make_shared<ResAction>(INVALID_VALUE, 0, ACTION_TYPE_PERFLVL, EVENT_OFF, 1,
+        MAX_INT_VALUE);
+    offHead->resAction->thermalActions = thermalActions;
+    socPerfThreadWrap->DoFreqActionPack(offHead);
+    SocPerfStateSnapshot offSnapshot;
+    socPerfThreadWrap->GetStateSnapshot(offSnapshot);
+    EXPECT_TRUE(offSnapshot.resStatus[resId].resActionList[ACTION_TYPE_PERFLVL].empty());
+    socPerfConfig.minThermalLvl_ = minThermalLvl;
+}
+
+/*
+ * @tc.name: SocPerfServerTest_ThermalLvl_002
+ * @tc.desc: test perf level holds never count as boosting, with or without a value at the thermal level
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfServerTest, SocPerfServerTest_ThermalLvl_002, Function | MediumTest | Level0)
+{
+    int32_t resId = AddTestResNodes(1)[0];
+    SocPerfConfig& socPerfConfig = SocPerfConfig::GetInstance();
+    int32_t minThermalLvl = socPerfConfig.minThermalLvl_;
+    socPerfConfig.minThermalLvl_ = 1;
+    auto thermalActions = std::make_shared<Actions>(0, "thermal");
+    auto action = std::make_shared<Action>();
+    action->thermalLvl_ = 1;
+    action->variable = {resId, 1000};
+    thermalActions->actionList.push_back(action);
+    socPerfConfig.BuildThermalLvlTable(thermalActions);
+
+    auto socPerfThreadWrap = std::make_shared<SocPerfThreadWrap>();
+    socPerfThreadWrap->resStatusInfo_[resId] = std::make_shared<ResStatus>();
+    auto head = std::make_shared<ResActionItem>(resId);
+    head->resAction = std::make_shared<ResAction>(INVALID_VALUE, 0, ACTION_TYPE_PERFLVL, EVENT_ON, 1, MAX_INT_VALUE);
+    head->resAction->thermalActions = thermalActions;
+    socPerfThreadWrap->DoFreqActionPack(head);
+    SocPerfStateSnapshot snapshot;
+    socPerfThreadWrap->GetStateSnapshot(snapshot);
+    EXPECT_FALSE(snapshot.resStatus[resId].resActionList[ACTION_TYPE_PERFLVL].empty());
+    EXPECT_EQ(socPerfThreadWrap->boostResCnt, 0);
+
+    socPerfThreadWrap->SetThermalLevel(2);
+    SocPerfStateSnapshot hotSnapshot;
+    socPerfThreadWrap->GetStateSnapshot(hotSnapshot);
+    EXPECT_EQ(hotSnapshot.resStatus[resId].candidatesValue[ACTION_TYPE_PERFLVL], 1000);
+    EXPECT_EQ(socPerfThreadWrap->boostResCnt, 0);
+
+    auto offHead = std::make_shared<ResActionItem>(resId);
+    offHead->resAction = std::make_shared<ResAction>(INVALID_VALUE, 0, ACTION_TYPE_PERFLVL, EVENT_OFF, 1,
+        MAX_INT_VALUE);
+    offHead->resAction->thermalActions = thermalActions;
+    socPerfThreadWrap->DoFreqActionPack(offHead);
+    SocPerfStateSnapshot offSnapshot;
+    socPerfThreadWrap->GetStateSnapshot(offSnapshot);
+    EXPECT_TRUE(offSnapshot.resStatus[resId].resActionList[ACTION_TYPE_PERFLVL].empty());
+    EXPECT_EQ(socPerfThreadWrap->boostResCnt, 0);
+    socPerfConfig.minThermalLvl_ = minThermalLvl;
+}
+
+/*
+ * @tc.name: SocPerfServerTest_ThermalLvlTable_001
+ * @tc.desc: test the thermal level table selects the nearest action at or below each level
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfServerTest, SocPerfServerTest_ThermalLvlTable_001, Function | MediumTest | Level0)
+{
+    std::vector<int32_t> resIds = AddTestResNodes(2);
+    SocPerfConfig& socPerfConfig = SocPerfConfig::GetInstance();
+    auto thermalActions = std::make_shared<Actions>(0, "thermal");
+    const std::vector<std::pair<int32_t, std::vector<int64_t>>> levels = {
+        {1, {resIds[0], 1000, resIds[1], 900}},
+        {4, {resIds[0], 600, RES_ID_ADDITION, 1}},
+        {1, {resIds[0], 800}},
+    };
+    for (const auto& level : levels) {
+        auto action = std::make_shared<Action>();
+        action->thermalLvl_ = level.first;
+        action->variable = level.second;
+        thermalActions->actionList.push_back(action);
+    }
+    socPerfConfig.BuildThermalLvlTable(thermalActions);
+    EXPECT_EQ(thermalActions->thermalResIds, resIds);
+    EXPECT_EQ(thermalActions->thermalLvlBase, 1);
+    EXPECT_EQ(thermalActions->GetThermalLvlValue(0, 0), INVALID_VALUE);
+    // the later action of level 1 replaces the earlier one, level 2 and 3 reuse it
+    EXPECT_EQ(thermalActions->GetThermalLvlValue(1, 0), 800);
+    EXPECT_EQ(thermalActions->GetThermalLvlValue(3, 0), 800);
+    EXPECT_EQ(thermalActions->GetThermalLvlValue(3, 1), INVALID_VALUE);
+    EXPECT_EQ(thermalActions->GetThermalLvlValue(4, 0), 600);
+    EXPECT_EQ(thermalActions->GetThermalLvlValue(MAX_THERMAL_LVL, 0), 600);
+}
+
+/*
+ * @tc.name: SocPerfServerTest_DeviceModeMask_001
+ * @tc.desc: test device modes are matched through the active mode mask
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfServerTest, SocPerfServerTest_DeviceModeMask_001, Function | MediumTest | Level0)
+{
+    const std::string modeType = "deviceModeMaskTest";
+    const std::vector<int32_t> cmdIds = {99990, 99991, 99992};
+    SocPerfConfig& socPerfConfig = SocPerfConfig::GetInstance();
+    std::unordered_map<int32_t, std::shared_ptr<Actions>>& perfActionsInfo =
+        socPerfConfig.configPerfActionsInfo_[DEFAULT_CONFIG_MODE];
+    if (socPerfConfig.sceneResourceInfo_.find(modeType) != socPerfConfig.sceneResourceInfo_.end() ||
+        perfActionsInfo.find(cmdIds[0]) != perfActionsInfo.end()) {
+        GTEST_SKIP() << "the config already uses the test mode or cmdIds";
+    }
+    auto sceneResNode = std::make_shared<SceneResNode>(modeType, REPORT_TO_PERFSO);
+    sceneResNode->items.push_back(std::make_shared<SceneItem>("maskTestB", REPORT_TO_PERFSO));
+    sceneResNode->items.push_back(std::make_shared<SceneItem>("maskTestA", 0));
+    socPerfConfig.sceneResourceInfo_[modeType] = sceneResNode;
+    for (int32_t cmdId : cmdIds) {
+        perfActionsInfo[cmdId] = std::make_shared<Actions>(cmdId, "maskTest");
+    }
+    perfActionsInfo[cmdIds[0]]->modeMap.push_back(std::make_shared<ModeMap>("maskTestA", cmdIds[1]));
+    perfActionsInfo[cmdIds[0]]->modeMap.push_back(std::make_shared<ModeMap>("maskTestB", cmdIds[2]));
+    socPerfConfig.BuildDeviceModes();
+
+    SocPerf socPerf;
+    EXPECT_EQ(socPerf.MatchDeviceModeCmd(cmdIds[0], false), cmdIds[0]);
+    EXPECT_EQ(socPerf.deviceModeMask_, 0ULL);
+    EXPECT_EQ(socPerf.MatchDeviceMode("maskTestB", true, sceneResNode), "maskTestB");
+    EXPECT_EQ(socPerf.MatchDeviceModeCmd(cmdIds[0], false), cmdIds[2]);
+    EXPECT_EQ(socPerf.deviceModeMask_, sceneResNode->items[0]->modeBit);
+    // the modes of one type exclude each other
+    EXPECT_EQ(socPerf.MatchDeviceMode("maskTestA", true, sceneResNode), "default");
+    EXPECT_EQ(socPerf.MatchDeviceModeCmd(cmdIds[0], false), cmdIds[1]);
+    EXPECT_EQ(socPerf.deviceModeMask_, sceneResNode->items[1]->modeBit);
+    socPerf.MatchDeviceMode("maskTestA", false, sceneResNode);
+    EXPECT_EQ(socPerf.MatchDeviceModeCmd(cmdIds[0], false), cmdIds[0]);
+
+    socPerfConfig.sceneResourceInfo_.erase(modeType);
+    for (int32_t cmdId : cmdIds) {
+        perfActionsInfo.erase(cmdId);
+    }
+    socPerfConfig.BuildDeviceModes();
+}
+
+/*
+ * @tc.name: SocPerfServerTest_ModePriority_001
+ * @tc.desc: test the cmd tables of active modes are overlaid by their priority
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfServerTest, SocPerfServerTest_ModePriority_001, Function | MediumTest | Level0)
+{
+    // the higher priority mode sorts last by name, the name order alone would pick the other one
+    const std::vector<std::string> modes = {"prioTestA", "prioTestB"};
+    const std::vector<int32_t> cmdIds = {99980, 99981, 99982};
+    SocPerfConfig& socPerfConfig = SocPerfConfig::GetInstance();
+    for (const std::string& mode : modes) {
+        if (socPerfConfig.sceneResourceInfo_.find(mode) != socPerfConfig.sceneResourceInfo_.end() ||
+            socPerfConfig.configPerfActionsInfo_.find(mode) != socPerfConfig.configPerfActionsInfo_.end()) {
+            GTEST_SKIP() << "the config already uses the test modes";
+        }
+    }
+    std::vector<std::shared_ptr<SceneResNode>> sceneResNodes;
+    for (const std::string& mode : modes) {
+        // one scene type each, so both can be active together
+        auto sceneResNode = std::make_shared<SceneResNode>(mode, REPORT_TO_PERFSO);
+        sceneResNode->items.push_back(std::make_shared<SceneItem>(mode, REPORT_TO_PERFSO));
+        socPerfConfig.sceneResourceInfo_[mode] = sceneResNode;
+        sceneResNodes.push_back(sceneResNode);
+    }
+    socPerfConfig.configModePriority_[modes[0]] = 1;
+    socPerfConfig.configModePriority_[modes[1]] = 5;
+    auto& defaultActionsInfo = socPerfConfig.configPerfActionsInfo_[DEFAULT_CONFIG_MODE];
+    for (int32_t cmdId : cmdIds) {
+        defaultActionsInfo[cmdId] = std::make_shared<Actions>(cmdId, DEFAULT_CONFIG_MODE);
+        socPerfConfig.configPerfActionsInfo_[modes[0]][cmdId] = std::make_shared<Actions>(cmdId, modes[0]);
+    }
+    socPerfConfig.configPerfActionsInfo_[modes[1]][cmdIds[0]] = std::make_shared<Actions>(cmdIds[0], modes[1]);
+    socPerfConfig.configPerfActionsInfo_[modes[0]].erase(cmdIds[2]);
+    socPerfConfig.BuildDeviceModes();
+    EXPECT_EQ(socPerfConfig.configModeOrder_, std::vector<std::string>({modes[0], modes[1]}));
+
+    SocPerf socPerf;
+    socPerf.UpdateActiveActionsInfo();
+    EXPECT_EQ(socPerf.GetActionsInfo(cmdIds[0])->name, DEFAULT_CONFIG_MODE);
+    socPerf.MatchDeviceMode(modes[0], true, sceneResNodes[0]);
+    socPerf.MatchDeviceMode(modes[1], true, sceneResNodes[1]);
+    EXPECT_EQ(socPerf.GetActionsInfo(cmdIds[0])->name, modes[1]);
+    EXPECT_EQ(socPerf.GetActionsInfo(cmdIds[1])->name, modes[0]);
+    EXPECT_EQ(socPerf.GetActionsInfo(cmdIds[2])->name, DEFAULT_CONFIG_MODE);
+    EXPECT_EQ(socPerf.GetMatchCmdId(cmdIds[2], false), cmdIds[2]);
+    socPerf.MatchDeviceMode(modes[1], false, sceneResNodes[1]);
+    EXPECT_EQ(socPerf.GetActionsInfo(cmdIds[0])->name, modes[0]);
+
+    for (const std::string& mode : modes) {
+        socPerfConfig.sceneResourceInfo_.erase(mode);
+        socPerfConfig.configPerfActionsInfo_.erase(mode);
+        socPerfConfig.configModePriority_.erase(mode);
+    }
+    for (int32_t cmdId : cmdIds) {
+        defaultActionsInfo.erase(cmdId);
+    }
+    socPerfConfig.BuildDeviceModes();
+}
+
+namespace {
+std::vector<std::string> g_scenarioMsgs;
+int ScenarioStub(const std::string& msgStr)
+{
+    g_scenarioMsgs.push_back(msgStr);
+    return 0;
+}
+}
+
+/*
+ * @tc.name: SocPerfServerTest_Scenario_001
+ * @tc.desc: test device mode scenarios are sent from the queue and coalesced per mode type
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfServerTest, SocPerfServerTest_Scenario_001, Function | MediumTest | Level0)
+{
+    SocPerfConfig& socPerfConfig = SocPerfConfig::GetInstance();
+    PerfScenarioFunc originScenarioFunc = socPerfConfig.scenarioFunc_;
+    socPerfConfig.scenarioFunc_ = ScenarioStub;
+    g_scenarioMsgs.clear();
+    auto socPerfThreadWrap = std::make_shared<SocPerfThreadWrap>();
+    auto started = std::make_shared<std::promise<void>>();
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    socPerfThreadWrap->SubmitQueueTask(QUEUE_TASK_STATUS, [started, opened]() {
+        started->set_value();
+        opened.wait();
+    });
+    started->get_future().wait();
+    socPerfThreadWrap->PostScenario("displayMode", "on");
+    socPerfThreadWrap->PostScenario("powerStatus", "perfMode");
+    socPerfThreadWrap->PostScenario("displayMode", "off");
+    socPerfThreadWrap->PostScenario("displayMode", "on");
+    EXPECT_TRUE(g_scenarioMsgs.empty());
+    EXPECT_EQ(socPerfThreadWrap->queueStats_.GetPendingCnt(), 2);
+    gate.set_value();
+    SocPerfStateSnapshot snapshot;
+    socPerfThreadWrap->GetStateSnapshot(snapshot);
+    std::vector<std::string> expected = {"displayMode:on", "powerStatus:perfMode"};
+    EXPECT_EQ(g_scenarioMsgs, expected);
+    EXPECT_TRUE(socPerfThreadWrap->pendingScenario_.empty());
+
+    socPerfThreadWrap->PostScenario("displayMode", "off");
+    socPerfThreadWrap->GetStateSnapshot(snapshot);
+    EXPECT_EQ(g_scenarioMsgs.back(), "displayMode:off");
+    socPerfConfig.scenarioFunc_ = originScenarioFunc;
+}
+
+/*
+ * @tc.name: SocPerfServerTest_HoldWatchdog_001
+ * @tc.desc: test a hold kept past the maxHold of its cmd is released and counted once
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfServerTest, SocPerfServerTest_HoldWatchdog_001, Function | MediumTest | Level0)
+{
+    int32_t resId = AddTestResNodes(1)[0];
+    int32_t cmdId = 10010;
+    // never due while the test runs, the expiry is driven through the queue as the timer would
+    const int32_t maxHoldMs = 600000;
+    auto socPerfThreadWrap = std::make_shared<SocPerfThreadWrap>();
+    socPerfThreadWrap->resStatusInfo_[resId] = std::make_shared<ResStatus>();
+    auto head = std::make_shared<ResActionItem>(resId);
+    head->resAction = std::make_shared<ResAction>(1000, 0, ACTION_TYPE_PERF, EVENT_ON, cmdId, MAX_INT_VALUE);
+    head->resAction->maxHoldMs = maxHoldMs;
+    head->resAction->reportExpiry = true;
+    socPerfThreadWrap->DoFreqActionPack(head);
+    socPerfThreadWrap->PostHoldWatchdog(head);
+    SocPerfStateSnapshot snapshot;
+    socPerfThreadWrap->GetStateSnapshot(snapshot);
+    EXPECT_EQ(snapshot.perfHolds[cmdId], 1);
+    EXPECT_TRUE(socPerfThreadWrap->holdWatchdogs_.find(cmdId) != socPerfThreadWrap->holdWatchdogs_.end());
+
+    socPerfThreadWrap->SubmitQueueTask(QUEUE_TASK_WATCHDOG, [socPerfThreadWrap, head]() {
+        socPerfThreadWrap->ExpireHolds({head});
+    });
+    SocPerfStateSnapshot expiredSnapshot;
+    socPerfThreadWrap->GetStateSnapshot(expiredSnapshot);
+    EXPECT_TRUE(expiredSnapshot.perfHolds.empty());
+    EXPECT_TRUE(expiredSnapshot.resStatus[resId].resActionList[ACTION_TYPE_PERF].empty());
+    EXPECT_EQ(expiredSnapshot.holdLeaks[cmdId], 1);
+    EXPECT_TRUE(socPerfThreadWrap->holdWatchdogs_.empty());
+
+    // a hold released by its off in time cancels its watchdog and is left alone
+    auto newHead = std::make_shared<ResActionItem>(resId);
+    newHead->resAction = std::make_shared<ResAction>(1000, 0, ACTION_TYPE_PERF, EVENT_ON, cmdId, MAX_INT_VALUE);
+    newHead->resAction->maxHoldMs = maxHoldMs;
+    newHead->resAction->reportExpiry = true;
+    socPerfThreadWrap->DoFreqActionPack(newHead);
+    socPerfThreadWrap->PostHoldWatchdog(newHead);
+    SocPerfStateSnapshot onSnapshot;
+    socPerfThreadWrap->GetStateSnapshot(onSnapshot);
+    EXPECT_TRUE(socPerfThreadWrap->holdWatchdogs_.find(cmdId) != socPerfThreadWrap->holdWatchdogs_.end());
+    auto offHead = std::make_shared<ResActionItem>(resId);
+    offHead->resAction = std::make_shared<ResAction>(1000, 0, ACTION_TYPE_PERF, EVENT_OFF, cmdId, MAX_INT_VALUE);
+    socPerfThreadWrap->DoFreqActionPack(offHead);
+    socPerfThreadWrap->SubmitQueueTask(QUEUE_TASK_WATCHDOG, [socPerfThreadWrap, newHead, head]() {
+        socPerfThreadWrap->ExpireHolds({newHead, head});
+    });
+    SocPerfStateSnapshot offSnapshot;
+    socPerfThreadWrap->GetStateSnapshot(offSnapshot);
+    EXPECT_EQ(offSnapshot.holdLeaks[cmdId], 1);
+    EXPECT_TRUE(socPerfThreadWrap->holdWatchdogs_.empty());
+}
+
+/*
+ * @tc.name: SocPerfServerTest_ClientHolds_001
+ * @tc.desc: test holds are kept per registered client and released when it dies
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfServerTest, SocPerfServerTest_ClientHolds_001, Function | MediumTest | Level0)
+{
+    int32_t pid = -1;
+    int32_t otherPid = -2;
+    int32_t cmdId = 10000;
+    int32_t clientId = ActionType::ACTION_TYPE_POWER;
+    socPerfServer_->clientHolds_[pid];
+    socPerfServer_->RecordPerfHold(pid, cmdId, cmdId, true);
+    socPerfServer_->RecordPerfHold(pid, cmdId, cmdId, false);
+    EXPECT_TRUE(socPerfServer_->clientHolds_[pid].perfHolds.empty());
+    socPerfServer_->RecordPerfHold(pid, cmdId, cmdId, true);
+    socPerfServer_->RecordPerfHold(pid, cmdId, cmdId, true);
+    socPerfServer_->RecordPerfHold(otherPid, cmdId, cmdId, true);
+    EXPECT_EQ(socPerfServer_->clientHolds_[pid].perfHolds, (std::map<int32_t, int32_t>({{cmdId, cmdId}})));
+    EXPECT_TRUE(socPerfServer_->clientHolds_.find(otherPid) == socPerfServer_->clientHolds_.end());
+
+    socPerfServer_->RecordLimitHold(pid, clientId, {1001, 1002 + RES_ID_ADDITION}, {999000, 1});
+    socPerfServer_->RecordLimitHold(otherPid, clientId, {1001}, {1325000});
+    EXPECT_TRUE(socPerfServer_->limitOwners_.find({clientId, 1001}) == socPerfServer_->limitOwners_.end());
+    EXPECT_EQ((socPerfServer_->limitOwners_[{clientId, 1002}]), pid);
+    EXPECT_NE(socPerfServer_->DumpClientHolds().find("pid -1"), std::string::npos);
+
+    socPerfServer_->ReleaseClientHolds(pid, nullptr);
+    EXPECT_TRUE(socPerfServer_->clientHolds_.find(pid) == socPerfServer_->clientHolds_.end());
+    EXPECT_TRUE(socPerfServer_->limitOwners_.find({clientId, 1002}) == socPerfServer_->limitOwners_.end());
+}
+
+/*
+ * @tc.name: SocPerfServerTest_ClientHolds_002
+ * @tc.desc: test a dead client only releases the matched holds no other client still holds, and records them
+ * @tc.type FUNC
+ * @tc.require:
+ */
+HWTEST_F(SocPerfServerTest, SocPerfServerTest_ClientHolds_002, Function | MediumTest | Level0)
+{
+    int32_t pid = -1;
+    int32_t otherPid = -2;
+    int32_t sharedCmdId = 10000;
+    int32_t cmdId = 10001;
+    // an on matched to a device mode cmdId is released on that cmdId
+    int32_t modeCmdId = 10002;
+    int32_t matchCmdId = 20002;
+    socPerfServer_->clientHolds_[pid];
+    socPerfServer_->clientHolds_[otherPid];
+    socPerfServer_->RecordPerfHold(pid, sharedCmdId, sharedCmdId, true);
+    socPerfServer_->RecordPerfHold(pid, cmdId, cmdId, true);
+    socPerfServer_->RecordPerfHold(pid, modeCmdId, matchCmdId, true);
+    socPerfServer_->RecordPerfHold(otherPid, sharedCmdId, sharedCmdId, true);
+    EXPECT_EQ(socPerfServer_->GetOrphanPerfHolds(pid), std::vector<int32_t>({cmdId, matchCmdId}));
+    EXPECT_TRUE(socPerfServer_->GetOrphanPerfHolds(otherPid).empty());
+
+    socPerfServer_->socPerf.StartRecord();
+    socPerfServer_->ReleaseClientHolds(pid, nullptr);
+    socPerfServer_->socPerf.StopRecord();
+    std::vector<uint8_t> data;
+    std::vector<SocPerfRecord> records;
+    EXPECT_TRUE(SocPerfRecorder::FromHex(socPerfServer_->socPerf.GetRecordHex(), data));
+    EXPECT_TRUE(SocPerfRecorder::Parse(data, records));
+    ASSERT_EQ(records.size(), 2);
+    EXPECT_EQ(records[1].entry, RECORD_ENTRY_PERF_REQUEST_EX);
+    EXPECT_EQ(records[1].id, matchCmdId);
+    EXPECT_FALSE(records[1].onOff);
+    EXPECT_EQ(records[1].pid, pid);
+    EXPECT_EQ(socPerfServer_->GetOrphanPerfHolds(otherPid), std::vector<int32_t>({sharedCmdId}));
+    // an off from anyone ends the shared hold for every client
+    socPerfServer_->RecordPerfHold(pid, sharedCmdId, sharedCmdId, false);
+    EXPECT_TRUE(socPerfServer_->clientHolds_[otherPid].perfHolds.empty());
+    socPerfServer_->ReleaseClientHolds(otherPid, nullptr);
+    EXPECT_TRUE(socPerfServer_->clientHolds_.find(otherPid) == socPerfServer_->clientHolds_.end());
+}
+
 /*
  * @tc.name: SocPerfServerTest_End_001
  * @tc.desc: perf end